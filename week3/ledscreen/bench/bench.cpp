@@ -0,0 +1,363 @@
+/*
+  Host benchmark for the ledscreen renderer.
+  Runs the render stages of loop() for a fixed sequence of animation times and
+  reports ns/frame, ns/pixel and p50/p99 per stage, plus a hash of all frames so
+  output changes show up next to timing changes.
+
+  pio run -e native -t exec
+  .pio/build/native/program -n 600 -s 0.0166 -d frames/
+  .pio/build/native/program -p 1 -b 8000000    pipelined present over a simulated 8 MHz bus
+  .pio/build/native/program -j 2               world and trees in 2 parallel bands, reported as world
+  .pio/build/native/program -c                 scrolled windows are copied by the panel, up to 256x256
+  .pio/build/native/program -P profile.csv     cycle histograms of the stages, same csv as the device dump
+  .pio/build/native/program -S forest.bin      render a scene made by tools/scene_tool instead of the built in one
+  .pio/build/native/program -T /dev/pts/3      stream every frame to tools/stream_viewer, see stream.h
+  .pio/build/native/program -q 3               render at a fixed detail level of quality.h
+  .pio/build/native/program -p 0 -b 8000000 -a 200   adapt the detail to 200 fps, frames run back to back
+  .pio/build/native/program -k 20000           time the pixel kernels of pixels.h, see kernels.cpp
+  .pio/build/native/program -t -b 8000000      render in strips with a hash per strip, see strips.h
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include <Adafruit_SSD1331.h>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "bands.h"
+#include "damage.h"
+#include "ledscreen.h"
+#include "present.h"
+#include "profile.h"
+#include "quality.h"
+#include "scroll.h"
+#include "stream.h"
+#include "strips.h"
+
+#define DEFAULT_FRAMES 600
+#define DEFAULT_TIME_STEP (1.0 / 60.0)
+
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+
+enum Stage {
+    STAGE_WORLD,
+    STAGE_TREES,
+    STAGE_DIFF,
+    STAGE_PRESENT,
+    STAGE_SWAP,
+    STAGE_FRAME,
+    STAGE_COUNT
+};
+
+static const char *stage_names[STAGE_COUNT] = {"world", "trees", "diff", "present", "swap", "frame"};
+
+void setup();
+extern Adafruit_SSD1331 display;
+
+int run_kernel_bench(int rounds);
+
+static_assert(SSD1331_WIDTH == SCREEN_WIDTH && SSD1331_HEIGHT == SCREEN_HEIGHT, "the mock panel must have the size of the build");
+
+static int64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint32_t hash_frame(uint32_t hash, const uint16_t *frame, size_t pixels) {
+    for (size_t i = 0; i < pixels; i++) {
+        hash = (hash ^ (frame[i] & 0xFF)) * FNV_PRIME;
+        hash = (hash ^ (frame[i] >> 8)) * FNV_PRIME;
+    }
+    return hash;
+}
+
+// write an rgb565 frame as binary ppm, expanding every channel to 8 bit
+static bool dump_ppm(const char *dir, int index, const uint16_t *frame) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%04d.ppm", dir, index);
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) return false;
+
+    fprintf(file, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    for (size_t i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
+        uint8_t r = (frame[i] >> 11) & 0x1F;
+        uint8_t g = (frame[i] >> 5) & 0x3F;
+        uint8_t b = frame[i] & 0x1F;
+        uint8_t rgb[3] = {(uint8_t)(r << 3 | r >> 2), (uint8_t)(g << 2 | g >> 4), (uint8_t)(b << 3 | b >> 2)};
+        fwrite(rgb, 1, sizeof(rgb), file);
+    }
+
+    return fclose(file) == 0;
+}
+
+static int64_t percentile(const std::vector<int64_t> &sorted, double p) {
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+static bool write_profile(const char *path) {
+    static char csv[4096];
+    int length = profile_write_csv(csv, sizeof(csv));
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL) return false;
+
+    fwrite(csv, 1, length, file);
+    return fclose(file) == 0;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [-n frames] [-s time step in sec] [-d ppm dump dir]\n", name);
+    fprintf(stderr, "          [-p pipelined 0/1] [-b simulated bus hz] [-v verify every frame] [-j band workers]\n");
+    fprintf(stderr, "          [-c panel side copies] [-P profile csv] [-S scene file]\n");
+    fprintf(stderr, "          [-T stream frames to tty or file] [-q fixed quality level] [-a adaptive quality fps]\n");
+    fprintf(stderr, "          [-k pixel kernel rounds] [-t strip renderer]\n");
+}
+
+// the panel must show the frame, whatever the present path skipped
+static bool verify_panel(const uint16_t *frame) {
+    present_wait();
+    return memcmp(display.gddram, frame, sizeof(display.gddram)) == 0;
+}
+
+int main(int argc, char **argv) {
+    int frames = DEFAULT_FRAMES;
+    double time_step = DEFAULT_TIME_STEP;
+    const char *dump_dir = NULL;
+    bool pipelined = true;
+    uint32_t bus_hz = 0;
+    bool verify = false;
+    int workers = 0;
+    bool panel_copies = false;
+    const char *profile_path = NULL;
+    const char *scene_path = NULL;
+    const char *stream_path = NULL;
+    int fixed_quality = -1;
+    int adaptive_fps = 0;
+    int kernel_rounds = 0;
+    bool strips = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            time_step = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+            dump_dir = argv[++i];
+        } else if (!strcmp(argv[i], "-p") && i + 1 < argc) {
+            pipelined = atoi(argv[++i]) != 0;
+        } else if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+            bus_hz = strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-P") && i + 1 < argc) {
+            profile_path = argv[++i];
+        } else if (!strcmp(argv[i], "-S") && i + 1 < argc) {
+            scene_path = argv[++i];
+        } else if (!strcmp(argv[i], "-T") && i + 1 < argc) {
+            stream_path = argv[++i];
+        } else if (!strcmp(argv[i], "-q") && i + 1 < argc) {
+            fixed_quality = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-a") && i + 1 < argc) {
+            adaptive_fps = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-k") && i + 1 < argc) {
+            kernel_rounds = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-c")) {
+            panel_copies = true;
+        } else if (!strcmp(argv[i], "-t")) {
+            strips = true;
+        } else if (!strcmp(argv[i], "-v")) {
+            verify = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // strips keep no frame to copy from, stream or split into bands
+    bool strips_conflict = strips && (panel_copies || workers > 0 || stream_path != NULL);
+    if (frames <= 0 || fixed_quality >= QUALITY_LEVEL_COUNT || (fixed_quality >= 0 && adaptive_fps > 0) || strips_conflict) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // the kernels run on their own buffers, no frame is rendered
+    if (kernel_rounds > 0) return run_kernel_bench(kernel_rounds);
+
+    if (dump_dir != NULL && mkdir(dump_dir, 0755) != 0 && errno != EEXIST) {
+        perror(dump_dir);
+        return 1;
+    }
+
+    setup();
+    if (scene_path != NULL && !load_scene(scene_path)) return 1;
+
+    if (stream_path != NULL) {
+        if (!Serial.open_port(stream_path)) {
+            perror(stream_path);
+            return 1;
+        }
+        stream_begin();
+    }
+    present_begin(&display, pipelined);
+    display.bus_hz = bus_hz;
+    bands_begin(workers);
+    profile_reset();
+
+    // without -q or -a the bench renders every frame at full detail
+    quality_begin(adaptive_fps);
+    if (fixed_quality >= 0) quality_force((QualityLevel)fixed_quality);
+    uint32_t quality_frames[QUALITY_LEVEL_COUNT] = {};
+    uint32_t quality_changes = 0;
+
+    std::vector<int64_t> samples[STAGE_COUNT];
+    for (int s = 0; s < STAGE_COUNT; s++) samples[s].reserve(frames);
+
+    uint32_t hash = FNV_OFFSET_BASIS;
+    uint64_t bytes_before = display.bytes_sent;
+    uint64_t pixels_rewritten = 0;
+    uint64_t windows = 0;
+    uint64_t copies = 0;
+    uint32_t strip_columns_before = strip_columns_computed;
+
+    for (int frame = 0; frame < frames; frame++) {
+        double time = frame * time_step;
+        int64_t t[STAGE_COUNT + 1];
+
+        // the same profile stages as loop(), render_bands() profiles its own bands
+        t[0] = now_ns();
+        uint32_t mark = profile_cycles();
+        Damage damage = {};
+        int strips_sent = 0;
+        if (strips) {
+            // render, diff and present overlap strip by strip, all of it is reported as world
+            strips_sent = render_strips(time);
+            t[1] = t[2] = t[3] = t[4] = t[5] = now_ns();
+        } else if (workers > 0) {
+            render_bands(time);
+            t[1] = t[2] = now_ns();
+            mark = profile_cycles();
+        } else {
+            build_world_layers(time);
+            t[1] = now_ns();
+            profile_stage_end(PROFILE_WORLD, &mark);
+            plant_trees(time);
+            t[2] = now_ns();
+            profile_stage_end(PROFILE_TREES, &mark);
+        }
+        if (!strips) {
+            collect_damage(bitmap, old_bitmap, &damage);
+            if (panel_copies) find_panel_copies(bitmap, old_bitmap, &damage);
+            t[3] = now_ns();
+            profile_stage_end(PROFILE_DIFF, &mark);
+            present_submit(bitmap, &damage);
+            if (stream_path != NULL) stream_submit(bitmap);
+            t[4] = now_ns();
+            profile_stage_end(PROFILE_PRESENT, &mark);
+            swap_frame_buffers();
+            t[5] = now_ns();
+            profile_stage_end(PROFILE_SWAP, &mark);
+
+            profile_count(PROFILE_PIXELS_REWRITTEN, damage_area(&damage));
+            profile_count(PROFILE_SPI_BYTES, damage_bytes(&damage));
+        }
+        profile_count(PROFILE_FRAMES, 1);
+
+        for (int s = 0; s < STAGE_FRAME; s++) samples[s].push_back(t[s + 1] - t[s]);
+        samples[STAGE_FRAME].push_back(t[5] - t[0]);
+
+        // the bench stages as loop() reports them to the quality controller, world and trees are render
+        FrameTiming timing = {};
+        timing.stage_us[FRAME_STAGE_RENDER] = (t[2] - t[0]) / 1000;
+        timing.stage_us[FRAME_STAGE_DIFF] = (t[3] - t[2]) / 1000;
+        timing.stage_us[FRAME_STAGE_PRESENT] = (t[4] - t[3]) / 1000;
+        timing.stage_us[FRAME_STAGE_SWAP] = (t[5] - t[4]) / 1000;
+
+        QualityLevel level = quality_level();
+        quality_update(&timing);
+        quality_frames[level]++;
+        if (quality_level() != level) quality_changes++;
+
+        // after the swap the frame just built is old_bitmap, strips only have the panel to show it,
+        // waiting for the last strip keeps the next frame from overlapping with it
+        const uint16_t *shown = old_bitmap;
+        if (strips) {
+            present_wait();
+            shown = display.gddram;
+        }
+        hash = hash_frame(hash, shown, SCREEN_WIDTH * SCREEN_HEIGHT);
+        pixels_rewritten += strips ? strips_sent * STRIP_ROWS * SCREEN_WIDTH : damage_area(&damage);
+        windows += strips ? strips_sent : damage.count;
+        copies += damage.copy_count;
+
+        if (verify && !strips && !verify_panel(old_bitmap)) {
+            fprintf(stderr, "frame %d: panel does not match the rendered frame\n", frame);
+            return 1;
+        }
+
+        if (dump_dir != NULL && !dump_ppm(dump_dir, frame, shown)) {
+            perror(dump_dir);
+            return 1;
+        }
+    }
+
+    if (!strips && !verify_panel(old_bitmap)) {
+        fprintf(stderr, "last frame: panel does not match the rendered frame\n");
+        return 1;
+    }
+    if (stream_path != NULL) stream_wait();
+
+    printf("frames: %d, time step: %.4f s, panel: %dx%d, pipelined: %d, bus: %u hz, band workers: %d\n", frames, time_step,
+           SCREEN_WIDTH, SCREEN_HEIGHT, pipelined, bus_hz, band_workers());
+    printf("scene: %s, %d layers, %d trees\n", scene_path != NULL ? scene_path : "built in", amount_of_layer, amount_of_trees);
+    printf("%-8s %12s %10s %12s %12s %12s\n", "stage", "ns/frame", "ns/pixel", "p50 ns", "p99 ns", "max ns");
+
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        std::vector<int64_t> &v = samples[s];
+        int64_t total = 0;
+        for (size_t i = 0; i < v.size(); i++) total += v[i];
+        std::sort(v.begin(), v.end());
+
+        double mean = (double)total / v.size();
+        printf("%-8s %12.0f %10.2f %12lld %12lld %12lld\n", stage_names[s], mean, mean / (SCREEN_WIDTH * SCREEN_HEIGHT),
+               (long long)percentile(v, 0.50), (long long)percentile(v, 0.99), (long long)v.back());
+    }
+
+    printf("spi bytes/frame: %.0f, pixels rewritten/frame: %.0f, windows/frame: %.2f\n",
+           (double)(display.bytes_sent - bytes_before) / frames, (double)pixels_rewritten / frames, (double)windows / frames);
+    printf("panel copies/frame: %.2f, layer strip columns/frame: %.1f\n", (double)copies / frames,
+           (double)(strip_columns_computed - strip_columns_before) / frames);
+    if (strips) {
+        printf("panel state: %u bytes, %d strips of %d rows\n", (unsigned)STRIP_MEMORY_BYTES, STRIP_COUNT, STRIP_ROWS);
+    } else {
+        printf("panel state: %u bytes in two frame buffers\n", (unsigned)(2 * SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t)));
+    }
+    if (stream_path != NULL) {
+        StreamStats stream = stream_stats();
+        printf("stream packets: %u, skipped: %u, bytes/packet: %.0f, compression: %.1fx\n", stream.frames_sent,
+               stream.frames_skipped, (double)stream.bytes_sent / stream.frames_sent,
+               (double)stream.frames_sent * SCREEN_WIDTH * SCREEN_HEIGHT * 2 / stream.bytes_sent);
+    }
+    if (fixed_quality >= 0) {
+        printf("quality: fixed at %s\n", quality_level_names[fixed_quality]);
+    } else if (adaptive_fps > 0) {
+        printf("quality: adaptive to %d fps, %u changes, frames per level:", adaptive_fps, quality_changes);
+        for (int q = 0; q < QUALITY_LEVEL_COUNT; q++) printf(" %s %u%s", quality_level_names[q], quality_frames[q], q < QUALITY_LEVEL_COUNT - 1 ? "," : "\n");
+    }
+    printf("frame hash: 0x%08x\n", hash);
+
+    if (profile_path != NULL && !write_profile(profile_path)) {
+        perror(profile_path);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+/*
+  Benchmark of the pixel kernels in pixels.h, started with bench -k.
+
+  Every kernel is checked against a one pixel at a time version for all
+  alignments and lengths up to two rows, then both are timed on the spans the
+  renderer hands them: world column gaps, sprite runs, frame rows and the
+  whole frame.
+
+  .pio/build/native/program -k 20000
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include <stdio.h>
+#include <time.h>
+
+#include "ledscreen.h"
+#include "pixels.h"
+
+// spans of the size the renderer uses
+#define GAP_PIXELS 12
+#define RUN_PIXELS 7
+#define FRAME_PIXELS (SCREEN_WIDTH * SCREEN_HEIGHT)
+
+typedef struct {
+    const char *name;
+    int pixels;
+    // offset of the span in the buffers, odd starts test the single pixel head
+    int offset;
+    // pixel of b that differs from a, -1 for equal spans
+    int changed;
+} Case;
+
+static const Case cases[] = {
+    {"column gap", GAP_PIXELS, 1, -1},
+    {"sprite run", RUN_PIXELS, 3, -1},
+    {"row equal", SCREEN_WIDTH, 0, -1},
+    {"row middle", SCREEN_WIDTH, 0, SCREEN_WIDTH / 2 + 1},
+    {"frame", FRAME_PIXELS, 0, -1},
+};
+
+static uint16_t a[FRAME_PIXELS + 2] __attribute__((aligned(4)));
+static uint16_t b[FRAME_PIXELS + 2] __attribute__((aligned(4)));
+
+// the result of every call goes in here so the loops are not optimized away
+static volatile int sink;
+
+static int64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void scalar_fill(uint16_t *dst, uint16_t color, int count) {
+    for (int i = 0; i < count; i++) dst[i] = color;
+}
+
+static void scalar_copy(uint16_t *dst, const uint16_t *src, int count) {
+    for (int i = 0; i < count; i++) dst[i] = src[i];
+}
+
+static int scalar_first(const uint16_t *x, const uint16_t *y, int count) {
+    int i = 0;
+    while (i < count && x[i] == y[i]) i++;
+    return i;
+}
+
+static int scalar_last(const uint16_t *x, const uint16_t *y, int count) {
+    int i = count - 1;
+    while (i >= 0 && x[i] == y[i]) i--;
+    return i;
+}
+
+// every alignment of both spans and every length up to two rows against the scalar versions
+static bool check_kernels() {
+    static uint16_t expected[2 * SCREEN_WIDTH + 2];
+
+    for (int a_offset = 0; a_offset < 2; a_offset++) {
+        for (int b_offset = 0; b_offset < 2; b_offset++) {
+            for (int count = 0; count <= 2 * SCREEN_WIDTH; count++) {
+                uint16_t *x = &a[a_offset];
+                uint16_t *y = &b[b_offset];
+
+                // the pixel after the span must stay untouched
+                x[count] = 0xFFFF;
+                fill_pixels(x, 0x1234, count);
+                scalar_fill(expected, 0x1234, count);
+                if (memcmp(x, expected, count * sizeof(uint16_t)) != 0 || x[count] != 0xFFFF) {
+                    fprintf(stderr, "fill_pixels: wrong at %d pixels from %d\n", count, a_offset);
+                    return false;
+                }
+
+                for (int i = 0; i < count; i++) y[i] = i * 40503u;
+                x[count] = 0xFFFF;
+                copy_pixels(x, y, count);
+                if (memcmp(x, y, count * sizeof(uint16_t)) != 0 || x[count] != 0xFFFF) {
+                    fprintf(stderr, "copy_pixels: wrong at %d pixels from %d to %d\n", count, b_offset, a_offset);
+                    return false;
+                }
+
+                // one or two changed pixels at every position
+                for (int first = -1; first < count; first++) {
+                    int last = first < 0 ? -1 : (first * 7 + 3) % (count - first) + first;
+                    copy_pixels(x, y, count);
+                    if (first >= 0) x[first] ^= 0x0800;
+                    if (last >= 0) x[last] ^= 0x0001;
+
+                    int found_first, found_last;
+                    bool changed = diff_pixels(x, y, count, &found_first, &found_last);
+                    bool expected_changed = first >= 0;
+
+                    if (first_changed_pixel(x, y, count) != scalar_first(x, y, count) ||
+                        last_changed_pixel(x, y, count) != scalar_last(x, y, count) || changed != expected_changed ||
+                        (changed && (found_first != first || found_last != last)) ||
+                        pixels_equal(x, y, count) == expected_changed) {
+                        fprintf(stderr, "row diff: wrong at %d pixels changed %d..%d, alignment %d %d\n", count, first,
+                                last, a_offset, b_offset);
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// ns per call of body, repeated rounds times
+#define TIME_NS(rounds, body)                                  \
+    ({                                                         \
+        int64_t begin = now_ns();                              \
+        for (int round = 0; round < (rounds); round++) body;   \
+        (double)(now_ns() - begin) / (rounds);                 \
+    })
+
+static void print_result(const char *kernel, const Case *c, double scalar_ns, double kernel_ns) {
+    printf("%-8s %-12s %8d %12.1f %12.1f %8.2fx\n", kernel, c->name, c->pixels, scalar_ns, kernel_ns, scalar_ns / kernel_ns);
+}
+
+int run_kernel_bench(int rounds) {
+    if (!check_kernels()) return 1;
+
+    printf("pixel kernels, %d rounds per span, every kernel checked against the scalar version\n", rounds);
+    printf("%-8s %-12s %8s %12s %12s %9s\n", "kernel", "span", "pixels", "scalar ns", "kernel ns", "speedup");
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const Case *c = &cases[i];
+        // the whole frame is timed a hundred times less often than a row
+        int n = c->pixels > SCREEN_WIDTH ? rounds / 100 + 1 : rounds;
+        uint16_t *x = &a[c->offset];
+        uint16_t *y = &b[c->offset];
+
+        for (int p = 0; p < c->pixels; p++) x[p] = y[p] = p * 40503u;
+        if (c->changed >= 0) x[c->changed] ^= 1;
+
+        if (c->changed < 0) {
+            double scalar_ns = TIME_NS(n, (scalar_fill(x, round, c->pixels), sink = x[0]));
+            double kernel_ns = TIME_NS(n, (fill_pixels(x, round, c->pixels), sink = x[0]));
+            print_result("fill", c, scalar_ns, kernel_ns);
+
+            scalar_ns = TIME_NS(n, (scalar_copy(x, y, c->pixels), sink = x[0]));
+            kernel_ns = TIME_NS(n, (copy_pixels(x, y, c->pixels), sink = x[0]));
+            print_result("copy", c, scalar_ns, kernel_ns);
+        }
+
+        int first, last;
+        double scalar_ns = TIME_NS(n, (sink = scalar_first(x, y, c->pixels) + scalar_last(x, y, c->pixels)));
+        double kernel_ns = TIME_NS(n, (sink = diff_pixels(x, y, c->pixels, &first, &last)));
+        print_result("row diff", c, scalar_ns, kernel_ns);
+    }
+    return 0;
+}
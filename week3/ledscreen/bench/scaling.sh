@@ -0,0 +1,19 @@
+#!/bin/sh
+# Frame time of the renderer for every panel size it is built for.
+# Builds the native bench of each size and prints its stages next to each other,
+# the options are passed to every bench, so -t compares the strip renderer.
+#
+#   sh bench/scaling.sh -n 600
+#   sh bench/scaling.sh -n 600 -t -b 40000000
+#
+# MIT License
+# Copyright (c) 2024 Jesse van Vuuren
+
+set -e
+cd "$(dirname "$0")/.."
+
+for env in native native_240x240 native_320x240; do
+    pio run -s -e "$env"
+    echo "== $env"
+    ".pio/build/$env/program" "$@" | grep -E "^(frames|stage|world|trees|diff|present|frame |spi|panel state)"
+done
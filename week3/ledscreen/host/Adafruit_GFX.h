@@ -0,0 +1,22 @@
+/*
+  Host stand-in for Adafruit_GFX, only what the ledscreen renderer uses.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+class Adafruit_GFX {
+   public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+   protected:
+    int16_t _width;
+    int16_t _height;
+};
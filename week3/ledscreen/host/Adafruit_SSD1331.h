@@ -0,0 +1,62 @@
+/*
+  Host stand-in for Adafruit_SSD1331.
+  Keeps a copy of the panel memory so frames can be checked and dumped,
+  and counts what would have gone over the SPI bus.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include <Adafruit_GFX.h>
+
+// the mock takes the panel size of a build for a larger panel, so the bench runs it against the same calls
+#if defined(SCREEN_WIDTH) && defined(SCREEN_HEIGHT)
+#define SSD1331_WIDTH SCREEN_WIDTH
+#define SSD1331_HEIGHT SCREEN_HEIGHT
+#else
+#define SSD1331_WIDTH 96
+#define SSD1331_HEIGHT 64
+#endif
+
+#define SSD1331_CMD_COPY 0x23
+
+class Adafruit_SSD1331 : public Adafruit_GFX {
+   public:
+    Adafruit_SSD1331(int8_t cs, int8_t dc, int8_t mosi, int8_t sclk, int8_t rst);
+
+    void begin(uint32_t freq = 0);
+    void drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h);
+
+    // Adafruit_SPITFT low level writes, pixels fill the window row by row
+    void startWrite();
+    void endWrite();
+    void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+    void writePixels(uint16_t *colors, uint32_t len, bool block = true, bool bigEndian = false);
+
+    // command bytes, the mock understands the copy command (0x23) and its six arguments
+    void writeCommand(uint8_t cmd);
+
+    // panel memory, what the OLED would show right now
+    uint16_t gddram[SSD1331_WIDTH * SSD1331_HEIGHT];
+
+    // bus counters, bytes include command bytes
+    uint32_t transactions;
+    uint32_t bytes_sent;
+
+    // simulated SPI clock, 0 = transfers take no time
+    uint32_t bus_hz;
+
+   private:
+    // current address window and write position inside it
+    uint16_t window_x, window_y, window_w, window_h;
+    uint32_t window_pos;
+
+    // bytes of the open transaction, endWrite() waits for their bus time
+    uint32_t transaction_bytes;
+
+    // command being received and its arguments so far
+    uint8_t command[7];
+    uint8_t command_length;
+};
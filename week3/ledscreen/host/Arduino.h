@@ -0,0 +1,58 @@
+/*
+  Host stand-in for the Arduino core, only what the ledscreen renderer uses.
+  Compiled in the [env:native] build, never on the ESP32.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROGMEM
+
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define radians(deg) ((deg) * DEG_TO_RAD)
+
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// microseconds since start of the process, like the ESP-IDF timer
+int64_t esp_timer_get_time();
+
+// serial output goes to stderr so benchmark results on stdout stay clean
+class HardwareSerial {
+   public:
+    void begin(unsigned long baud);
+    void print(const char *s);
+    void print(char c);
+    void print(int n);
+    void print(unsigned int n);
+    void print(long n);
+    void print(unsigned long n);
+    void print(double n);
+    void println();
+    void println(const char *s);
+    void println(int n);
+    void println(unsigned long n);
+    void println(double n);
+    size_t write(const uint8_t *buffer, size_t size);
+
+    // host only: send write() to a tty, pty or file instead of stderr, like the ESP32 uart
+    bool open_port(const char *path);
+
+    // there is no serial input on the host
+    int available();
+    int read();
+};
+
+extern HardwareSerial Serial;
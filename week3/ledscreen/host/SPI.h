@@ -0,0 +1,8 @@
+/*
+  Host stand-in for the Arduino SPI library, the mock panel needs no bus.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
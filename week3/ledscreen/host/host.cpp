@@ -0,0 +1,178 @@
+/*
+  Host implementation of the Arduino, ESP-IDF and SSD1331 stand-ins.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include <Adafruit_SSD1331.h>
+#include <Arduino.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// the address window command of the SSD1331 is 6 bytes: 0x15 x0 x1 0x75 y0 y1
+#define SSD1331_WINDOW_COMMAND_BYTES 6
+
+HardwareSerial Serial;
+
+// where write() goes, stderr until open_port()
+static int serial_port = STDERR_FILENO;
+
+static int64_t monotonic_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static const int64_t boot_us = monotonic_us();
+
+int64_t esp_timer_get_time() {
+    return monotonic_us() - boot_us;
+}
+
+unsigned long millis() {
+    return esp_timer_get_time() / 1000;
+}
+
+unsigned long micros() {
+    return esp_timer_get_time();
+}
+
+void delay(unsigned long ms) {
+    struct timespec ts = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000};
+    nanosleep(&ts, NULL);
+}
+
+void delayMicroseconds(unsigned int us) {
+    struct timespec ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+    nanosleep(&ts, NULL);
+}
+
+void HardwareSerial::begin(unsigned long baud) {}
+void HardwareSerial::print(const char *s) { fputs(s, stderr); }
+void HardwareSerial::print(char c) { fputc(c, stderr); }
+void HardwareSerial::print(int n) { fprintf(stderr, "%d", n); }
+void HardwareSerial::print(unsigned int n) { fprintf(stderr, "%u", n); }
+void HardwareSerial::print(long n) { fprintf(stderr, "%ld", n); }
+void HardwareSerial::print(unsigned long n) { fprintf(stderr, "%lu", n); }
+void HardwareSerial::print(double n) { fprintf(stderr, "%.2f", n); }
+void HardwareSerial::println() { fputc('\n', stderr); }
+void HardwareSerial::println(const char *s) { fprintf(stderr, "%s\n", s); }
+void HardwareSerial::println(int n) { fprintf(stderr, "%d\n", n); }
+void HardwareSerial::println(unsigned long n) { fprintf(stderr, "%lu\n", n); }
+void HardwareSerial::println(double n) { fprintf(stderr, "%.2f\n", n); }
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+        ssize_t n = ::write(serial_port, buffer + written, size - written);
+        if (n <= 0) break;
+        written += n;
+    }
+    return written;
+}
+
+bool HardwareSerial::open_port(const char *path) {
+    int port = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_NOCTTY, 0644);
+    if (port < 0) return false;
+
+    // a tty must pass the binary stream untouched
+    struct termios settings;
+    if (tcgetattr(port, &settings) == 0) {
+        cfmakeraw(&settings);
+        tcsetattr(port, TCSANOW, &settings);
+    }
+
+    serial_port = port;
+    return true;
+}
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+
+Adafruit_SSD1331::Adafruit_SSD1331(int8_t cs, int8_t dc, int8_t mosi, int8_t sclk, int8_t rst)
+    : Adafruit_GFX(SSD1331_WIDTH, SSD1331_HEIGHT), gddram(), transactions(0), bytes_sent(0), bus_hz(0),
+      window_x(0), window_y(0), window_w(SSD1331_WIDTH), window_h(SSD1331_HEIGHT), window_pos(0), transaction_bytes(0), command(), command_length(0) {}
+
+void Adafruit_SSD1331::begin(uint32_t freq) {
+    memset(gddram, 0, sizeof(gddram));
+    transactions = 0;
+    bytes_sent = 0;
+}
+
+// same clipping as Adafruit_SPITFT: one address window, then all pixels in one burst
+void Adafruit_SSD1331::drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) {
+    int16_t x0 = x < 0 ? 0 : x;
+    int16_t y0 = y < 0 ? 0 : y;
+    int16_t x1 = x + w > _width ? _width : x + w;
+    int16_t y1 = y + h > _height ? _height : y + h;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    for (int16_t row = y0; row < y1; row++) {
+        memcpy(&gddram[row * SSD1331_WIDTH + x0], &bitmap[(row - y) * w + (x0 - x)], (x1 - x0) * sizeof(uint16_t));
+    }
+
+    transactions++;
+    bytes_sent += SSD1331_WINDOW_COMMAND_BYTES + (x1 - x0) * (y1 - y0) * sizeof(uint16_t);
+}
+
+void Adafruit_SSD1331::startWrite() {
+    transactions++;
+    transaction_bytes = bytes_sent;
+}
+
+// the bus is busy for 8 clocks per byte of the transaction
+void Adafruit_SSD1331::endWrite() {
+    if (bus_hz == 0) return;
+
+    int64_t bus_us = (int64_t)(bytes_sent - transaction_bytes) * 8 * 1000000 / bus_hz;
+    int64_t until = esp_timer_get_time() + bus_us;
+    while (esp_timer_get_time() < until) {
+    }
+}
+
+void Adafruit_SSD1331::setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    window_x = x;
+    window_y = y;
+    window_w = w;
+    window_h = h;
+    window_pos = 0;
+    bytes_sent += SSD1331_WINDOW_COMMAND_BYTES;
+}
+
+// the panel wraps inside the window like the real controller does
+void Adafruit_SSD1331::writePixels(uint16_t *colors, uint32_t len, bool block, bool bigEndian) {
+    for (uint32_t i = 0; i < len; i++) {
+        uint32_t pos = window_pos++ % (window_w * window_h);
+        uint16_t x = window_x + pos % window_w;
+        uint16_t y = window_y + pos / window_w;
+        if (x < SSD1331_WIDTH && y < SSD1331_HEIGHT) gddram[y * SSD1331_WIDTH + x] = colors[i];
+    }
+    bytes_sent += len * sizeof(uint16_t);
+}
+
+// copy [x0, x1] x [y0, y1] to (x2, y2) inside the panel memory, overlapping windows move like memmove
+static void copy_window(uint16_t *gddram, const uint8_t *args) {
+    int x0 = args[0], y0 = args[1], x1 = args[2], y1 = args[3], x2 = args[4], y2 = args[5];
+    int width = x1 - x0 + 1;
+    if (width <= 0 || y1 < y0 || x2 + width > SSD1331_WIDTH || y2 + y1 - y0 >= SSD1331_HEIGHT) return;
+
+    for (int y = y0; y <= y1; y++) {
+        int source = y * SSD1331_WIDTH + x0;
+        int target = (y2 + y - y0) * SSD1331_WIDTH + x2;
+        memmove(&gddram[target], &gddram[source], width * sizeof(uint16_t));
+    }
+}
+
+void Adafruit_SSD1331::writeCommand(uint8_t cmd) {
+    bytes_sent++;
+
+    if (command_length == 0 && cmd != SSD1331_CMD_COPY) return;
+    command[command_length++] = cmd;
+
+    if (command_length == sizeof(command)) {
+        copy_window(gddram, &command[1]);
+        command_length = 0;
+    }
+}
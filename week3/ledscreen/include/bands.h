@@ -0,0 +1,31 @@
+/*
+  Band parallel rendering.
+  The bitmap is split into horizontal bands, one per worker, and every worker
+  builds the world and plants the trees of its own band. render_bands() returns
+  once every band is finished, so the diff and present stages always see a
+  complete frame.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+
+// the ESP32 has two cores, the host build may use more
+#define MAX_RENDER_WORKERS 8
+
+// above the transfer task so rendering is never starved by the bus
+#define BAND_TASK_STACK_SIZE 4096
+#define BAND_TASK_PRIORITY 2
+
+// start one worker per band, worker i is pinned to core i on the ESP32
+// 0 workers renders the frame on the calling task
+void bands_begin(int workers);
+
+// render world and trees of the whole frame, blocks until every band is done,
+// with workers the world and trees profile stages are the time of band 0
+void render_bands(double time);
+
+int band_workers();
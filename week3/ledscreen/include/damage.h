@@ -0,0 +1,70 @@
+/*
+  Damage tracking between two frames.
+  Finds the rectangles that changed since the previous frame so only those
+  windows are sent to the SSD1331 instead of everything below the first change.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+
+// most windows sent per frame, beyond this the cheapest neighbours are merged
+#define MAX_DAMAGE_RECTS 8
+
+// bytes it costs to open a window (address command and transaction) next to 2 bytes per pixel,
+// two rectangles are merged when sending the pixels in between is cheaper than another window
+#define DAMAGE_WINDOW_COST_BYTES 16
+
+// bytes the SSD1331 commands of a window and a panel side copy take on the bus
+#define SSD1331_WINDOW_COMMAND_BYTES 6
+#define SSD1331_COPY_COMMAND_BYTES 7
+
+// the copy command addresses columns and rows with one byte each, a larger panel gets no copies
+#define PANEL_COPY_FITS (SCREEN_WIDTH <= 256 && SCREEN_HEIGHT <= 256)
+
+// widest horizontal move tried when looking for panel side copies
+#define MAX_COPY_DX 8
+
+// a panel side copy only pays off when it saves more than this many bytes,
+// the SSD1331 needs time to finish the copy before new pixels are written
+#define MIN_COPY_SAVED_BYTES 64
+
+// pixels [x0, x1) x [y0, y1)
+typedef struct {
+    int16_t x0;
+    int16_t y0;
+    int16_t x1;
+    int16_t y1;
+} Rect;
+
+// the pixels of rect moved dx columns to the left since the previous frame (right when negative),
+// the panel copies them itself instead of receiving them again
+typedef struct {
+    Rect rect;
+    int16_t dx;
+} Copy;
+
+// changed rectangles of one frame, sorted top to bottom and not overlapping,
+// copies are done on the panel before the rectangles are sent
+typedef struct Damage {
+    Rect rects[MAX_DAMAGE_RECTS];
+    int count;
+    Copy copies[MAX_DAMAGE_RECTS];
+    int copy_count;
+} Damage;
+
+// compare frame against previous and collect the changed rectangles
+void collect_damage(const uint16_t *frame, const uint16_t *previous, Damage *damage);
+
+// replace changed rectangles that are a horizontal move of the previous frame
+// by a panel side copy and the columns that scrolled into view, does nothing unless PANEL_COPY_FITS
+void find_panel_copies(const uint16_t *frame, const uint16_t *previous, Damage *damage);
+
+// pixels that will be rewritten on the panel for this damage
+uint32_t damage_area(const Damage *damage);
+
+// bytes sent over SPI for this damage, commands and pixels
+uint32_t damage_bytes(const Damage *damage);
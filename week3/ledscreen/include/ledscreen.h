@@ -0,0 +1,114 @@
+/*
+  Shared types and render stages of the ledscreen valley animation.
+  Used by the firmware (src/ledscreen.cpp) and by the host benchmark (bench/).
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+// panel geometry, fixed at compile time so every buffer and loop bound is a constant,
+// a build for another panel sets both with -D, see the native_240x240 and native_320x240 envs,
+// the pixel format is not configurable, every buffer holds rgb565 in uint16_t
+#if defined(SCREEN_WIDTH) != defined(SCREEN_HEIGHT)
+#error "set both SCREEN_WIDTH and SCREEN_HEIGHT for another panel"
+#endif
+#ifndef SCREEN_WIDTH
+#define SCREEN_WIDTH 96
+#endif
+#ifndef SCREEN_HEIGHT
+#define SCREEN_HEIGHT 64
+#endif
+
+// rows are stored in uint8_t, see scroll.h and sun.h
+static_assert(SCREEN_HEIGHT <= 255, "rows must fit in uint8_t");
+
+// the built in scene is drawn for the 96x64 SSD1331, other panels stretch it
+#define DESIGN_WIDTH 96
+#define DESIGN_HEIGHT 64
+
+// upper bounds for layers[] and trees[], per layer and per tree state is kept in fixed arrays
+#define MAX_LAYERS 16
+#define MAX_TREES 32
+
+// define full circle so sine wave is seamless
+#define FULL_CIRCLE 360
+
+typedef struct {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+} Color;
+
+// Background layer settings
+typedef struct {
+    Color color;
+    int amplitude;
+    // phase step per column, sine_phase_step(waves per FULL_CIRCLE columns, FULL_CIRCLE)
+    uint32_t frequency;
+    int pos_y;
+    float speed;
+    float darken_color;
+} Background;
+
+// Tree settings
+typedef struct {
+    int pos_x;
+    int pos_y;
+    float leaf1_shade;
+    float leaf2_shade;
+    float leaf3_shade;
+    int height;
+    int width;
+    int root_height;
+    int root_width;
+    int speed;
+} Tree;
+
+// colors of the scene, the built in scene or the one loaded by load_scene()
+extern Color sky;
+extern Color sun;
+extern Color tree_bark;
+extern Color tree_leaf;
+
+// range of sun over the valley
+extern float sun_range;
+
+// frame buffers, bitmap is the frame being built, old_bitmap the frame on the panel
+extern uint16_t *old_bitmap;
+extern uint16_t *bitmap;
+
+// first panel row held by bitmap, 0 unless the strip renderer points bitmap at one strip
+extern int bitmap_first_row;
+
+// row y of the frame being built, the render stages only write through this
+static inline uint16_t *bitmap_row(int y) {
+    return &bitmap[(y - bitmap_first_row) * SCREEN_WIDTH];
+}
+
+extern int amount_of_layer;
+extern Background layers[MAX_LAYERS];
+
+extern int amount_of_trees;
+extern Tree trees[MAX_TREES];
+
+Color darken_color(Color c, float percentage);
+uint16_t color_to_hex(Color c);
+
+// render stages, called in this order from loop()
+void build_world_layers(double time);
+void plant_trees(double time);
+
+// the same stages limited to the rows [y_begin, y_end), bands never write outside their rows,
+// prepare_world() scrolls the layers once per frame before any band is built
+void prepare_world(double time);
+void build_world_band(int y_begin, int y_end);
+void plant_trees_band(double time, int y_begin, int y_end);
+void swap_frame_buffers();
+
+// replace the scene with the one at source, see scene.h, keeps the current scene when it fails
+bool load_scene(const char *source);
+
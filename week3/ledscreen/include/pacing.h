@@ -0,0 +1,52 @@
+/*
+  Frame scheduler.
+  Every frame starts on a fixed slot of the target frame rate, and the stages of
+  loop() are timed against their budget. The timings are handed to the telemetry
+  task, loop() itself never prints.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+
+// stages of loop(), in the order they run
+typedef enum {
+    FRAME_STAGE_RENDER,
+    FRAME_STAGE_DIFF,
+    FRAME_STAGE_PRESENT,
+    FRAME_STAGE_SWAP,
+    FRAME_STAGE_COUNT
+} FrameStage;
+
+extern const char *frame_stage_names[FRAME_STAGE_COUNT];
+
+// time spent in one frame, all in microseconds
+typedef struct {
+    uint32_t frame;
+    uint32_t stage_us[FRAME_STAGE_COUNT];
+    uint32_t idle_us;
+    // bit per stage that ran over its budget
+    uint8_t over_budget;
+    // the frame started a whole slot or more after its deadline
+    bool late;
+    // detail level the frame was rendered at, see quality.h
+    uint8_t quality;
+} FrameTiming;
+
+// target_fps = 0 runs frames back to back, stage_budget_us holds FRAME_STAGE_COUNT budgets
+void pacing_begin(uint16_t target_fps, const uint32_t *stage_budget_us);
+
+// sleep until the slot of the next frame, returns the slot time in microseconds from boot
+int64_t frame_begin();
+
+// end the stage that ran since frame_begin() or the previous stage_end()
+void stage_end(FrameStage stage);
+
+// timing of the frame being run, filled in by stage_end()
+FrameTiming *frame_timing();
+
+// hand the timing of the frame to the telemetry task
+void frame_end();
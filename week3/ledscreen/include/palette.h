@@ -0,0 +1,42 @@
+/*
+  All colors the renderer draws, baked to rgb565 once at startup.
+  The render stages only copy and blend these 16 bit values, no float color
+  math or rgb888 conversion is left in the frame loop.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+
+// blend weights are 0..BLEND_ALPHA_MAX so both lanes of blend_rgb565 fit in 32 bit
+#define BLEND_ALPHA_MAX 64
+
+// leaf layers per tree, see draw_tree() for the order
+#define TREE_LEAF_COUNT 3
+
+typedef struct {
+    uint16_t sky;
+    uint16_t sun;
+    uint16_t tree_bark;
+    uint16_t layer_shade[MAX_LAYERS];
+    uint16_t layer_plain[MAX_LAYERS];
+    uint16_t leaf[MAX_TREES][TREE_LEAF_COUNT];
+} Palette;
+
+extern Palette palette;
+
+// bake the color constants, layers and tree shades, call again when they change
+void build_palette();
+
+// blend fg over bg, alpha 0 = bg, BLEND_ALPHA_MAX = fg
+// red/blue and green are blended in separate lanes so channels never carry into each other,
+// the constants add half a step to every channel so the result is rounded
+static inline uint16_t blend_rgb565(uint16_t fg, uint16_t bg, uint8_t alpha) {
+    uint32_t rest = BLEND_ALPHA_MAX - alpha;
+    uint32_t rb = ((fg & 0xF81F) * alpha + (bg & 0xF81F) * rest + 0x10020) >> 6;
+    uint32_t g = ((fg & 0x07E0) * alpha + (bg & 0x07E0) * rest + 0x0400) >> 6;
+    return (rb & 0xF81F) | (g & 0x07E0);
+}
@@ -0,0 +1,144 @@
+/*
+  Fill, copy and compare kernels for rgb565 spans.
+  Two pixels are handled per 32 bit word, the native width of the ESP32. A
+  span that starts on an odd pixel does that one pixel alone first, two spans
+  that are not aligned the same way fall back to one pixel at a time.
+
+  The word loops are plain C, the host compiler may vectorize fill and copy
+  further, the compares stay one word per step like on the device.
+
+  Pixels are always 16 bit rgb565, a panel with another format needs its own
+  kernels and a conversion in present.cpp.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// the pixel with the lower index is in the low half of a word
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "pixel pairs assume a little endian cpu");
+
+// two pixels, may alias the uint16_t frame buffers they are read from
+typedef uint32_t __attribute__((__may_alias__)) PixelPair;
+
+static inline bool is_pair_aligned(const uint16_t *p) {
+    return ((uintptr_t)p & 2) == 0;
+}
+
+// set count pixels of dst to color
+static inline void fill_pixels(uint16_t *dst, uint16_t color, int count) {
+    if (count <= 0) return;
+    if (!is_pair_aligned(dst)) {
+        *dst++ = color;
+        count--;
+    }
+
+    PixelPair pair = color | (uint32_t)color << 16;
+    PixelPair *pairs = (PixelPair *)dst;
+    for (int i = 0; i < count / 2; i++) pairs[i] = pair;
+
+    if (count & 1) dst[count - 1] = color;
+}
+
+// copy count pixels from src to dst, the spans may not overlap
+static inline void copy_pixels(uint16_t *dst, const uint16_t *src, int count) {
+    int i = 0;
+
+    if (is_pair_aligned(dst) == is_pair_aligned(src)) {
+        if (count > 0 && !is_pair_aligned(dst)) {
+            dst[0] = src[0];
+            i = 1;
+        }
+
+        PixelPair *pairs = (PixelPair *)(dst + i);
+        const PixelPair *source = (const PixelPair *)(src + i);
+        for (int n = (count - i) / 2; n > 0; n--) *pairs++ = *source++;
+        i += (count - i) & ~1;
+    }
+
+    for (; i < count; i++) dst[i] = src[i];
+}
+
+// index of the first pixel where a and b differ, count when they are equal
+static inline int first_changed_pixel(const uint16_t *a, const uint16_t *b, int count) {
+    int i = 0;
+
+    if (is_pair_aligned(a) == is_pair_aligned(b)) {
+        if (count > 0 && !is_pair_aligned(a)) {
+            if (a[0] != b[0]) return 0;
+            i = 1;
+        }
+
+        const PixelPair *pa = (const PixelPair *)(a + i);
+        const PixelPair *pb = (const PixelPair *)(b + i);
+        for (; i + 1 < count; i += 2) {
+            uint32_t changed = *pa++ ^ *pb++;
+            if (changed) return (changed & 0xFFFF) ? i : i + 1;
+        }
+    }
+
+    for (; i < count; i++) {
+        if (a[i] != b[i]) return i;
+    }
+    return count;
+}
+
+// index of the last pixel where a and b differ, -1 when they are equal
+static inline int last_changed_pixel(const uint16_t *a, const uint16_t *b, int count) {
+    int i = count;
+
+    if (is_pair_aligned(a) == is_pair_aligned(b)) {
+        if (count > 0 && !is_pair_aligned(a + count)) {
+            if (a[count - 1] != b[count - 1]) return count - 1;
+            i = count - 1;
+        }
+
+        const PixelPair *pa = (const PixelPair *)(a + i);
+        const PixelPair *pb = (const PixelPair *)(b + i);
+        for (; i >= 2; i -= 2) {
+            uint32_t changed = *--pa ^ *--pb;
+            if (changed) return (changed >> 16) ? i - 1 : i - 2;
+        }
+    }
+
+    for (; i > 0; i--) {
+        if (a[i - 1] != b[i - 1]) return i - 1;
+    }
+    return -1;
+}
+
+// first and last differing pixel of two rows, false when the rows are equal
+static inline bool diff_pixels(const uint16_t *a, const uint16_t *b, int count, int *first, int *last) {
+    *first = first_changed_pixel(a, b, count);
+    if (*first == count) return false;
+
+    *last = last_changed_pixel(a, b, count);
+    return true;
+}
+
+static inline bool pixels_equal(const uint16_t *a, const uint16_t *b, int count) {
+    return first_changed_pixel(a, b, count) == count;
+}
+
+// FNV-1a over pixel pairs, a fingerprint to compare a span with the one of an earlier frame,
+// changing a single pair always changes the hash
+#define PIXEL_HASH_BASIS 2166136261u
+#define PIXEL_HASH_PRIME 16777619u
+
+// hash count pixels on top of hash, start with PIXEL_HASH_BASIS
+static inline uint32_t hash_pixels(const uint16_t *pixels, int count, uint32_t hash) {
+    int i = 0;
+    if (count > 0 && !is_pair_aligned(pixels)) {
+        hash = (hash ^ pixels[0]) * PIXEL_HASH_PRIME;
+        i = 1;
+    }
+
+    const PixelPair *pairs = (const PixelPair *)(pixels + i);
+    for (; i + 1 < count; i += 2) hash = (hash ^ *pairs++) * PIXEL_HASH_PRIME;
+
+    if (i < count) hash = (hash ^ pixels[i]) * PIXEL_HASH_PRIME;
+    return hash;
+}
@@ -0,0 +1,52 @@
+/*
+  Present stage, sends the changed windows of a frame to the SSD1331.
+
+  In pipelined mode the transfer of frame N runs on its own task while loop()
+  builds frame N+1 into the other frame buffer, so a frame costs the slower of
+  render and transfer instead of their sum. The frame passed to present_submit()
+  must not be written until present_ready() says its transfer finished.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include <Adafruit_SSD1331.h>
+
+#include "damage.h"
+#include "ledscreen.h"
+
+// stack of the transfer task, the SPI calls need very little
+#define PRESENT_TASK_STACK_SIZE 4096
+#define PRESENT_TASK_PRIORITY 1
+
+// core 1 runs loop(), the transfer runs next to the wifi stack on core 0
+#define PRESENT_TASK_CORE 0
+
+// SSD1331 graphic acceleration command that copies a window inside the panel memory
+#ifndef SSD1331_CMD_COPY
+#define SSD1331_CMD_COPY 0x23
+#endif
+
+// the copy runs inside the controller, give it time before new pixels land next to it
+#define SSD1331_COPY_SETTLE_US 100
+
+// pipelined = false sends every frame from inside present_submit()
+void present_begin(Adafruit_SSD1331 *display, bool pipelined);
+
+// waits for the previous transfer and starts sending the damage of frame
+void present_submit(const uint16_t *frame, const Damage *damage);
+
+// the same for the full width rows [y_begin, y_end), rows holds only those rows
+void present_submit_rows(const uint16_t *rows, int y_begin, int y_end);
+
+// fence of the last submitted frame: true when its transfer finished
+bool present_ready();
+
+// block until the last submitted frame is on the panel
+void present_wait();
+
+// write the damage of frame to the panel, copies first, blocks until it is sent,
+// frame starts at row first_row of the panel
+void write_damage(Adafruit_SSD1331 *display, const uint16_t *frame, int first_row, const Damage *damage);
@@ -0,0 +1,111 @@
+/*
+  Per stage profiling with cycle counters.
+  Every stage duration goes into a fixed size log linear histogram of CPU cycles,
+  so min, p50, p99 and max can be read at any time without storing samples.
+  The ESP32 reads the CCOUNT register, the host reads the TSC or the monotonic
+  clock. Frame counters such as pixels rewritten and SPI bytes sit next to them.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+
+#if !defined(ESP32) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#elif !defined(ESP32)
+#include <time.h>
+#endif
+
+// 8 sub buckets per power of two, every bucket is at most 12.5% wide
+#define PROFILE_SUB_BUCKET_BITS 3
+#define PROFILE_SUB_BUCKETS (1 << PROFILE_SUB_BUCKET_BITS)
+#define PROFILE_HISTOGRAM_BUCKETS ((32 - PROFILE_SUB_BUCKET_BITS + 1) * PROFILE_SUB_BUCKETS)
+
+// time spent calibrating the cycle counter against esp_timer_get_time()
+#define PROFILE_CALIBRATION_MS 20
+
+// first bytes of a binary dump, bump the version when ProfileSnapshot changes
+#define PROFILE_SNAPSHOT_MAGIC 0x46525049
+#define PROFILE_SNAPSHOT_VERSION 1
+
+typedef enum {
+    PROFILE_WORLD,
+    PROFILE_TREES,
+    PROFILE_DIFF,
+    PROFILE_PRESENT,
+    PROFILE_SWAP,
+    PROFILE_STAGE_COUNT
+} ProfileStage;
+
+typedef enum {
+    PROFILE_FRAMES,
+    PROFILE_PIXELS_REWRITTEN,
+    PROFILE_SPI_BYTES,
+    PROFILE_COUNTER_COUNT
+} ProfileCounter;
+
+extern const char *profile_stage_names[PROFILE_STAGE_COUNT];
+extern const char *profile_counter_names[PROFILE_COUNTER_COUNT];
+
+// all in cycles, p50 and p99 are the upper edge of their bucket
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t p50;
+    uint32_t p99;
+    uint32_t max;
+    uint64_t total;
+} ProfileStats;
+
+// fixed layout dump of the profile, little endian like both targets
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t stage_count;
+    uint8_t counter_count;
+    uint32_t cycles_per_mhz;
+    ProfileStats stages[PROFILE_STAGE_COUNT];
+    uint64_t counters[PROFILE_COUNTER_COUNT];
+} ProfileSnapshot;
+
+static inline uint32_t profile_cycles() {
+#if defined(ESP32)
+    return ESP.getCycleCount();
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+#endif
+}
+
+// calibrate the cycle counter and clear all histograms and counters
+void profile_begin();
+void profile_reset();
+
+// a stage reports from one task at a time, durations are differences so the counter may wrap
+void profile_record(ProfileStage stage, uint32_t cycles);
+void profile_count(ProfileCounter counter, uint32_t amount);
+
+// record the cycles since mark as stage and move mark to now
+static inline void profile_stage_end(ProfileStage stage, uint32_t *mark) {
+    uint32_t now = profile_cycles();
+    profile_record(stage, now - *mark);
+    *mark = now;
+}
+
+ProfileStats profile_stats(ProfileStage stage);
+uint64_t profile_counter(ProfileCounter counter);
+
+// cycles per second divided by a million, so 240 on a 240 MHz ESP32
+uint32_t profile_cycles_per_mhz();
+
+// csv with a row per stage in microseconds and a row per counter, returns the length
+// that would have been written like snprintf
+int profile_write_csv(char *buffer, size_t size);
+
+void profile_snapshot(ProfileSnapshot *snapshot);
@@ -0,0 +1,66 @@
+/*
+  Adaptive level of detail.
+  The stage times of every frame go into a running average that is compared to
+  the frame period. When the average keeps running over, the detail drops one
+  level, when it keeps finishing early the detail comes back one level. Every
+  level keeps the cuts of the levels before it.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+#include "pacing.h"
+
+typedef enum {
+    QUALITY_FULL,
+    // far layers only move every QUALITY_FAR_LAYER_FRAMES frames, so they stop adding damage
+    QUALITY_HOLD_FAR_LAYERS,
+    // the sun glow is not blended
+    QUALITY_NO_SUN,
+    // the world is built for every second column and doubled, trees stay full width
+    QUALITY_HALF_WIDTH,
+    QUALITY_LEVEL_COUNT
+} QualityLevel;
+
+extern const char *quality_level_names[QUALITY_LEVEL_COUNT];
+
+// the average is slow above this share of the period and fast below the other one,
+// the gap between them keeps the level from flipping every frame
+#define QUALITY_DEGRADE_PERCENT 90
+#define QUALITY_RESTORE_PERCENT 60
+
+// every frame moves the average 1 / 2^QUALITY_AVERAGE_SHIFT of the way to its own time
+#define QUALITY_AVERAGE_SHIFT 3
+
+// slow averages in a row before the detail drops, fast averages in a row before it comes back
+#define QUALITY_DEGRADE_FRAMES 4
+#define QUALITY_RESTORE_FRAMES 60
+
+// a level that had to be dropped again soon after it came back waits twice as long next time, up to this
+#define QUALITY_MAX_RESTORE_FRAMES 1920
+
+// layers this slow or slower, in columns per second, are far layers
+#define QUALITY_FAR_LAYER_SPEED 1.0f
+#define QUALITY_FAR_LAYER_FRAMES 4
+
+// target_fps = 0 always renders at full detail
+void quality_begin(uint16_t target_fps);
+
+// the level the next frames render at
+QualityLevel quality_level();
+
+// stay at level instead of adapting, QUALITY_LEVEL_COUNT adapts again
+void quality_force(QualityLevel level);
+
+// called from loop() once the frame is finished, records the level in timing and picks the next one
+void quality_update(FrameTiming *timing);
+
+// time the far layers are drawn at this frame, called once per frame
+double quality_far_layer_time(double time);
+
+static inline bool is_far_layer(const Background *layer) {
+    return layer->speed <= QUALITY_FAR_LAYER_SPEED && layer->speed >= -QUALITY_FAR_LAYER_SPEED;
+}
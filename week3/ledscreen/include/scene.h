@@ -0,0 +1,94 @@
+/*
+  Binary scene format.
+  Everything the valley is drawn from, the colors, sun, layers and trees, in a
+  versioned little endian file. The firmware maps it from the scene flash
+  partition, the host build from a file, and it is decoded into fixed arrays
+  without touching the heap. tools/scene_tool.cpp converts text scenes to it.
+
+  Layout, all little endian:
+    header  SCENE_HEADER_SIZE bytes, see the SCENE_AT_ offsets
+    layers  layer_count records of layer_record_size bytes
+    trees   tree_count records of tree_record_size bytes
+  A newer version may grow the records, readers skip the bytes they do not know.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+
+#define SCENE_MAGIC 0x454E4353  // "SCNE"
+#define SCENE_VERSION 1
+
+// header fields
+#define SCENE_AT_MAGIC 0
+#define SCENE_AT_VERSION 4
+#define SCENE_AT_HEADER_SIZE 6
+#define SCENE_AT_LAYER_COUNT 8
+#define SCENE_AT_TREE_COUNT 9
+#define SCENE_AT_LAYER_RECORD_SIZE 10
+#define SCENE_AT_TREE_RECORD_SIZE 11
+#define SCENE_AT_SKY 12
+#define SCENE_AT_SUN 15
+#define SCENE_AT_TREE_BARK 18
+#define SCENE_AT_TREE_LEAF 21
+#define SCENE_AT_SUN_RANGE 24
+#define SCENE_AT_CHECKSUM 28
+#define SCENE_HEADER_SIZE 32
+
+// layer record: rgb, amplitude i8, pos_y i16, waves per circle, speed and shade as f32
+#define SCENE_LAYER_RECORD_SIZE 20
+
+// tree record: pos_x i16, pos_y i16, three leaf shades f32, height, width, root height,
+// root width u8, speed i16
+#define SCENE_TREE_RECORD_SIZE 24
+
+// largest values the renderer handles, the sine phase and scroll offsets are integers
+#define SCENE_MAX_WAVES (FULL_CIRCLE / 2)
+#define SCENE_MAX_SPEED 1000
+
+// largest scene file, fits the scene partition many times over
+#define SCENE_MAX_SIZE (SCENE_HEADER_SIZE + MAX_LAYERS * 64 + MAX_TREES * 64)
+
+// label of the data partition setup() loads a scene from, on the host the bench loads one with -S
+#define SCENE_SOURCE "scene"
+
+// subtype of the scene data partition in partitions.csv
+#define SCENE_PARTITION_SUBTYPE 0x40
+
+typedef enum {
+    SCENE_OK,
+    SCENE_MISSING,
+    SCENE_TRUNCATED,
+    SCENE_BAD_MAGIC,
+    SCENE_BAD_VERSION,
+    SCENE_TOO_MANY,
+    SCENE_BAD_CHECKSUM,
+    SCENE_BAD_VALUE
+} SceneResult;
+
+typedef struct {
+    Color sky;
+    Color sun;
+    Color tree_bark;
+    Color tree_leaf;
+    float sun_range;
+    int layer_count;
+    Background layers[MAX_LAYERS];
+    int tree_count;
+    Tree trees[MAX_TREES];
+} Scene;
+
+// check and decode a scene file, scene is only written when the result is SCENE_OK,
+// values the renderer cannot draw (NaN, shades outside [0, 1], trees larger than a sprite) are SCENE_BAD_VALUE
+SceneResult decode_scene(const uint8_t *data, size_t size, Scene *scene);
+
+// encode scene into data, returns the size of the file, 0 when it does not fit
+size_t encode_scene(const Scene *scene, uint8_t *data, size_t size);
+
+// map the scene from source, decode it and unmap it again
+SceneResult read_scene(const char *source, Scene *scene);
+
+const char *scene_result_name(SceneResult result);
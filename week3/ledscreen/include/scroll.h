@@ -0,0 +1,43 @@
+/*
+  Incremental parallax scrolling.
+  A layer moves by whole columns, so the surface rows of the visible columns
+  are kept in a ring per layer. Scrolling only computes the columns that came
+  into view, a layer that does not move is computed once.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+
+// first row below the wave of a layer for the lookup indices [offset, offset + SCREEN_WIDTH),
+// index u lives in slot u % SCREEN_WIDTH
+typedef struct {
+    uint8_t wave_begin[SCREEN_WIDTH];
+    int offset;
+    bool valid;
+} LayerStrip;
+
+extern LayerStrip layer_strips[MAX_LAYERS];
+
+// columns computed by advance_layer_strip() since boot
+extern uint32_t strip_columns_computed;
+
+// slot of lookup index u, offsets may be negative for layers that scroll the other way
+static inline int strip_slot(int u) {
+    int slot = u % SCREEN_WIDTH;
+    return slot < 0 ? slot + SCREEN_WIDTH : slot;
+}
+
+// forget every strip, call when layers[] changes
+void reset_layer_strips();
+
+// move the strip of layer i to offset, returns the number of columns computed
+int advance_layer_strip(int i, int offset);
+
+// first row below the wave of the strip in screen column x
+static inline uint8_t strip_wave_begin(const LayerStrip *strip, int x) {
+    return strip->wave_begin[strip_slot(strip->offset + x)];
+}
@@ -0,0 +1,53 @@
+/*
+  Shared fixed point sine.
+  One quarter of a sine wave is generated at compile time into a const table,
+  so it lives in flash and costs nothing at boot. A phase is a uint32_t where
+  2^32 is a full circle, so stepping a phase wraps around without a seam.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// entries of the quarter wave, a full circle has 4 * SINE_QUARTER steps
+#define SINE_QUARTER_BITS 10
+#define SINE_QUARTER (1 << SINE_QUARTER_BITS)
+
+// sine values are Q14, so 1.0 is exact and fits an int16_t
+#define SINE_SHIFT 14
+#define SINE_ONE (1 << SINE_SHIFT)
+
+// bits of a phase below the table index
+#define SINE_INDEX_SHIFT (32 - SINE_QUARTER_BITS - 2)
+
+// sin of [0, quarter circle], the last entry is sin(90) so every quadrant mirrors cleanly
+typedef struct {
+    int16_t quarter[SINE_QUARTER + 1];
+} SineTable;
+
+extern const SineTable sine_table;
+
+// phase step for a wave that repeats waves times per circle of circle steps
+constexpr uint32_t sine_phase_step(double waves, int circle) {
+    return (uint32_t)((uint64_t)(waves * 4294967296.0 / circle + 0.5));
+}
+
+// sin of phase in Q14, rounded to the nearest table step
+static inline int16_t sine_at(uint32_t phase) {
+    uint32_t index = (phase + (1u << (SINE_INDEX_SHIFT - 1))) >> SINE_INDEX_SHIFT;
+    uint32_t step = index & (SINE_QUARTER - 1);
+
+    switch ((index >> SINE_QUARTER_BITS) & 3) {
+        case 0:
+            return sine_table.quarter[step];
+        case 1:
+            return sine_table.quarter[SINE_QUARTER - step];
+        case 2:
+            return -sine_table.quarter[step];
+        default:
+            return -sine_table.quarter[SINE_QUARTER - step];
+    }
+}
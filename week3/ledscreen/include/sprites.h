@@ -0,0 +1,62 @@
+/*
+  Pre-rasterized rgb565 sprites with a run length mask.
+  A sprite is drawn once into a canvas, only its opaque runs are kept, and
+  every frame the runs are copied into the bitmap with horizontal wraparound
+  and clipping to the rows being rendered.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+
+// canvas a sprite is drawn into before it is packed
+#define SPRITE_CANVAS_SIZE 64
+
+// shared storage of all sprites, filled once at startup
+#define MAX_SPRITES MAX_TREES
+#define SPRITE_RUN_POOL 1024
+#define SPRITE_PIXEL_POOL 4096
+
+// opaque pixels [x, x + length) of sprite row y, colors start at pixel in the pixel pool
+typedef struct {
+    uint8_t y;
+    uint8_t x;
+    uint8_t length;
+    uint16_t pixel;
+} SpriteRun;
+
+// x0, y0 is the top left of the canvas relative to the position the sprite is drawn at
+typedef struct {
+    int16_t x0;
+    int16_t y0;
+    uint16_t first_run;
+    uint16_t run_count;
+} Sprite;
+
+// canvas to draw a sprite into, x0, y0 is the canvas corner relative to the sprite position
+typedef struct {
+    int16_t x0;
+    int16_t y0;
+    uint16_t pixels[SPRITE_CANVAS_SIZE * SPRITE_CANVAS_SIZE];
+    bool mask[SPRITE_CANVAS_SIZE * SPRITE_CANVAS_SIZE];
+} SpriteCanvas;
+
+// forget every sprite
+void reset_sprites();
+
+// start drawing a sprite whose canvas corner is x0, y0 relative to its position
+void clear_sprite_canvas(SpriteCanvas *canvas, int x0, int y0);
+
+// draw a pixel relative to the sprite position, pixels off the canvas are dropped
+void sprite_canvas_pixel(SpriteCanvas *canvas, int x, int y, uint16_t color);
+
+// pack the canvas into a new sprite, returns its index or -1 when the pools are full
+int build_sprite(const SpriteCanvas *canvas);
+
+const Sprite *get_sprite(int index);
+
+// draw sprite at x, y into the rows [y_begin, y_end) of the bitmap, x wraps around the screen
+void blit_sprite(const Sprite *sprite, int x, int y, int y_begin, int y_end);
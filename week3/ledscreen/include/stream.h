@@ -0,0 +1,77 @@
+/*
+  Frame streaming over the serial port.
+  Every streamed frame is sent as a delta against the last frame the receiver
+  has: runs of unchanged pixels are skipped with a one byte token and changed
+  pixels follow a literal token as raw rgb565. tools/stream_viewer.cpp rebuilds
+  the frames on the host and reports bandwidth and compression.
+
+  Packet, little endian:
+    0   sync 0xA5 0x5A
+    2   type, STREAM_KEY or STREAM_DELTA
+    3   reserved
+    4   sequence u32, +1 for every packet sent
+    8   width u16, height u16
+    12  payload length u32
+    16  payload tokens, pixels past the last token are unchanged
+    ..  fnv-1a u32 of everything before it
+  Token byte t < 0x80 skips t + 1 pixels, t >= 0x80 is followed by t - 0x7F pixels.
+  A key frame is a delta against an all zero frame, so a receiver can start on it.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+
+#define STREAM_SYNC_0 0xA5
+#define STREAM_SYNC_1 0x5A
+#define STREAM_KEY 'K'
+#define STREAM_DELTA 'D'
+
+#define STREAM_HEADER_SIZE 16
+#define STREAM_CHECKSUM_SIZE 4
+
+// longest skip or literal run of one token
+#define STREAM_MAX_RUN 128
+#define STREAM_LITERAL 0x80
+
+// all literal is the worst case payload
+#define STREAM_MAX_PAYLOAD (SCREEN_WIDTH * SCREEN_HEIGHT * 2 + (SCREEN_WIDTH * SCREEN_HEIGHT + STREAM_MAX_RUN - 1) / STREAM_MAX_RUN)
+#define STREAM_MAX_PACKET (STREAM_HEADER_SIZE + STREAM_MAX_PAYLOAD + STREAM_CHECKSUM_SIZE)
+
+// a receiver that joins late or lost a packet recovers on the next key frame
+#define STREAM_KEYFRAME_INTERVAL 300
+
+#define STREAM_TASK_STACK_SIZE 4096
+#define STREAM_TASK_PRIORITY 0
+
+typedef struct {
+    uint32_t frames_sent;
+    // frames dropped because the previous packet was still being written
+    uint32_t frames_skipped;
+    uint64_t bytes_sent;
+} StreamStats;
+
+// start the task that writes packets to Serial
+void stream_begin();
+
+// queue frame unless a packet is still being written, then the frame is skipped
+// and the next delta is still against the last frame that was sent
+void stream_submit(const uint16_t *frame);
+
+// block until the queued packet is written
+void stream_wait();
+
+StreamStats stream_stats();
+
+// encode frame against reference into a packet and update reference to frame,
+// returns the packet size
+size_t encode_stream_packet(const uint16_t *frame, uint16_t *reference, uint32_t sequence, bool key, uint8_t *packet);
+
+// apply the payload of a delta to frame, false when it runs past the end of the frame
+bool apply_stream_payload(const uint8_t *payload, size_t size, uint16_t *frame, size_t pixels);
+
+// fnv-1a used for the packet checksum
+uint32_t stream_checksum(const uint8_t *data, size_t size);
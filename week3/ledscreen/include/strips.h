@@ -0,0 +1,42 @@
+/*
+  Strip renderer.
+  The frame is built STRIP_ROWS rows at a time into a small scratch buffer
+  instead of a full frame buffer. Only a hash of every strip is kept from the
+  previous frame: a strip whose hash did not change is not sent again, a
+  changed strip goes to the transfer task right away and is sent while the
+  next strip is built. Two scratch strips and the hashes replace the two
+  frame buffers, 3 KB instead of 24 KB.
+
+  A changed strip is always sent at full width, there are no previous pixels
+  to narrow it down, so it costs more bus bytes than the damage rectangles.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+
+// rows per strip, fewer rows send less for a small change but open more windows
+#define STRIP_ROWS 8
+#define STRIP_COUNT (SCREEN_HEIGHT / STRIP_ROWS)
+
+static_assert(SCREEN_HEIGHT % STRIP_ROWS == 0, "STRIP_ROWS must divide SCREEN_HEIGHT");
+
+// bytes of panel state the strip renderer keeps, scratch strips and hashes
+#define STRIP_MEMORY_BYTES (2 * STRIP_ROWS * SCREEN_WIDTH * sizeof(uint16_t) + STRIP_COUNT * sizeof(uint32_t))
+
+typedef struct {
+    uint32_t strips_sent;
+    uint32_t strips_skipped;
+} StripStats;
+
+// forget the hashes so the next frame sends every strip, after a scene change or when the panel was drawn over
+void reset_strips();
+
+// build, hash and send every strip of the frame at time, returns the strips sent,
+// the last strip may still be on the bus, present_wait() waits for it
+int render_strips(double time);
+
+StripStats strip_stats();
@@ -0,0 +1,38 @@
+/*
+  Sun glow over the top right corner of the valley.
+  The glow only depends on the pixel position, so its strength is computed once
+  in setup() and blended with integer math every frame.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+#include "palette.h"
+
+// most pixels the glow may reach, the built in scene reaches about 41% of the panel at every size,
+// load_scene() refuses a sun_range that reaches more
+#define SUN_GLOW_MAX_PIXELS (SCREEN_WIDTH * SCREEN_HEIGHT / 2)
+
+// the sun sits in the top right corner, so in every column it reaches the rows
+// [0, rows[x]) and its strength falls off with the distance to the corner
+typedef struct {
+    uint8_t rows[SCREEN_WIDTH];
+    uint32_t offset[SCREEN_WIDTH];
+    uint32_t size;
+    // every column packed after the one before it, only the pixels the glow reaches
+    uint8_t alpha[SUN_GLOW_MAX_PIXELS];
+} SunOverlay;
+
+extern SunOverlay sun_overlay;
+
+// pixels the glow of range reaches, at most SUN_GLOW_MAX_PIXELS fit in the overlay
+int sun_glow_pixels(float range);
+
+// compute the sun strength of every pixel it reaches, call again when sun_range changes
+void build_sun_overlay();
+
+// blend the sun over the rows of column x it reaches, limited to [y_begin, y_end)
+void blend_sun_column(int x, int y_begin, int y_end, uint16_t *column);
@@ -0,0 +1,43 @@
+/*
+  Frame telemetry.
+  loop() pushes the timing of every frame into a lock free ring, a low priority
+  task drains it in batches and prints one summary line per interval, so the
+  serial port never blocks the render loop. The same task answers profile
+  dump requests from the serial monitor.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "pacing.h"
+
+// power of two, a second of frames at 60 fps
+#define TELEMETRY_RING_SIZE 64
+
+// frames read from the ring at once
+#define TELEMETRY_BATCH_SIZE 16
+
+// the drain task only wakes up to print a summary
+#define TELEMETRY_INTERVAL_MS 1000
+#define TELEMETRY_TASK_STACK_SIZE 4096
+#define TELEMETRY_TASK_PRIORITY 0
+
+// characters read from serial: dump the profile as csv or binary snapshot, or clear it
+#define TELEMETRY_PROFILE_CSV 'p'
+#define TELEMETRY_PROFILE_BINARY 'b'
+#define TELEMETRY_PROFILE_RESET 'r'
+#define TELEMETRY_CSV_SIZE 512
+
+// start the drain task, serial_output = false keeps the port free for the frame stream
+void telemetry_begin(bool serial_output);
+
+// called from loop() only, the timing is dropped when the ring is full
+bool telemetry_push(const FrameTiming *timing);
+
+// called from the drain task only, copies up to max timings, returns how many
+int telemetry_drain(FrameTiming *timings, int max);
+
+// timings dropped because the ring was full
+uint32_t telemetry_dropped();
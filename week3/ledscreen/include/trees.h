@@ -0,0 +1,36 @@
+/*
+  Trees in the valley, drawn as sprites.
+  Trees with the same shape and colors share one sprite, so planting more trees
+  only costs the copy of their pixels.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#pragma once
+
+#include "ledscreen.h"
+#include "sprites.h"
+
+// rasterize every distinct tree of trees[] once, call after build_palette()
+void build_tree_sprites();
+
+// columns and rows of the sprite canvas draw_tree() in trees.cpp fills for tree:
+// three leaf triangles half a height apart and the roots below the lowest one
+static inline void tree_sprite_extent(const Tree *tree, int *columns, int *rows) {
+    int space = tree->height / 2;
+    int left = tree->width + tree->width / 2 - tree->height + 1;
+    int x0 = left < 0 ? left : 0;
+    int x1 = x0;
+    int y1 = tree->height + space;
+
+    if (tree->height > 0) x1 = tree->width + tree->height - 1 - tree->width / 2;
+    if (tree->root_height > 0 && tree->root_width > 0) {
+        int root_x1 = (tree->width + tree->root_width) / 2 + tree->root_width - 1;
+        if (root_x1 > x1) x1 = root_x1;
+        y1 += tree->root_height;
+    }
+
+    *columns = x1 - x0 + 1;
+    *rows = y1 + space;
+}
@@ -0,0 +1,150 @@
+/*
+  Band parallel rendering with a frame barrier.
+
+  The ESP32 runs a FreeRTOS task per band pinned to its own core, woken by a
+  task notification and reporting back through an event group. The host build
+  runs the same scheduler on std::thread so scaling and races can be checked.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "bands.h"
+
+#include "profile.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/task.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// workers in use, tasks beyond it stay asleep after bands_begin() lowered the count
+static int worker_count = 0;
+static int workers_started = 0;
+
+// time of the frame being rendered, written before the workers are woken
+static double band_time;
+
+// cycles render_bands() spent scrolling the layers, band 0 adds them to its world time
+static uint32_t prepare_cycles;
+
+// only band 0 is profiled, so each stage histogram has a single writer
+static void render_band(int band) {
+    int y_begin = band * SCREEN_HEIGHT / worker_count;
+    int y_end = (band + 1) * SCREEN_HEIGHT / worker_count;
+    uint32_t mark = profile_cycles() - prepare_cycles;
+
+    build_world_band(y_begin, y_end);
+    if (band == 0) profile_stage_end(PROFILE_WORLD, &mark);
+
+    plant_trees_band(band_time, y_begin, y_end);
+    if (band == 0) profile_stage_end(PROFILE_TREES, &mark);
+}
+
+#if defined(ESP32)
+
+static TaskHandle_t band_tasks[MAX_RENDER_WORKERS];
+static EventGroupHandle_t bands_done;
+
+static void band_task(void *arg) {
+    int band = (int)(intptr_t)arg;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        render_band(band);
+        xEventGroupSetBits(bands_done, 1 << band);
+    }
+}
+
+static void start_workers() {
+    if (bands_done == NULL) bands_done = xEventGroupCreate();
+
+    for (int i = workers_started; i < worker_count; i++) {
+        xTaskCreatePinnedToCore(band_task, "band", BAND_TASK_STACK_SIZE, (void *)(intptr_t)i, BAND_TASK_PRIORITY, &band_tasks[i],
+                                i % portNUM_PROCESSORS);
+    }
+}
+
+static void run_workers() {
+    EventBits_t all_bands = (1 << worker_count) - 1;
+
+    for (int i = 0; i < worker_count; i++) xTaskNotifyGive(band_tasks[i]);
+    xEventGroupWaitBits(bands_done, all_bands, pdTRUE, pdTRUE, portMAX_DELAY);
+}
+
+#else
+
+// never destroyed, the detached workers still wait on them when the program exits
+static std::mutex &band_mutex = *new std::mutex;
+static std::condition_variable &band_start = *new std::condition_variable;
+static std::condition_variable &band_done = *new std::condition_variable;
+static uint32_t band_generation = 0;
+static int bands_pending = 0;
+
+static void band_task(int band) {
+    uint32_t seen = 0;
+    std::unique_lock<std::mutex> lock(band_mutex);
+
+    for (;;) {
+        band_start.wait(lock, [&] { return band_generation != seen; });
+        seen = band_generation;
+        if (band >= worker_count) continue;
+
+        lock.unlock();
+        render_band(band);
+        lock.lock();
+
+        if (--bands_pending == 0) band_done.notify_one();
+    }
+}
+
+static void start_workers() {
+    for (int i = workers_started; i < worker_count; i++) std::thread(band_task, i).detach();
+}
+
+static void run_workers() {
+    std::unique_lock<std::mutex> lock(band_mutex);
+    bands_pending = worker_count;
+    band_generation++;
+    band_start.notify_all();
+
+    band_done.wait(lock, [] { return bands_pending == 0; });
+}
+
+#endif
+
+void bands_begin(int workers) {
+    if (workers > MAX_RENDER_WORKERS) workers = MAX_RENDER_WORKERS;
+
+    worker_count = workers;
+    if (worker_count > workers_started) {
+        start_workers();
+        workers_started = worker_count;
+    }
+}
+
+void render_bands(double time) {
+    uint32_t mark = profile_cycles();
+
+    if (worker_count == 0) {
+        build_world_layers(time);
+        profile_stage_end(PROFILE_WORLD, &mark);
+        plant_trees(time);
+        profile_stage_end(PROFILE_TREES, &mark);
+        return;
+    }
+
+    prepare_world(time);
+    prepare_cycles = profile_cycles() - mark;
+    band_time = time;
+    run_workers();
+}
+
+int band_workers() {
+    return worker_count;
+}
@@ -0,0 +1,143 @@
+/*
+  Damage tracking between two frames.
+
+  Rows are scanned top to bottom. Every changed row gives a rectangle from its
+  first to its last changed pixel, which is merged into the rectangle above it
+  when sending the union is cheaper than opening another window.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "damage.h"
+
+#include "pixels.h"
+
+static int32_t rect_area(Rect r) {
+    return (int32_t)(r.x1 - r.x0) * (r.y1 - r.y0);
+}
+
+static int32_t rect_cost(Rect r) {
+    return DAMAGE_WINDOW_COST_BYTES + rect_area(r) * sizeof(uint16_t);
+}
+
+static Rect rect_union(Rect a, Rect b) {
+    Rect r;
+    r.x0 = a.x0 < b.x0 ? a.x0 : b.x0;
+    r.y0 = a.y0 < b.y0 ? a.y0 : b.y0;
+    r.x1 = a.x1 > b.x1 ? a.x1 : b.x1;
+    r.y1 = a.y1 > b.y1 ? a.y1 : b.y1;
+    return r;
+}
+
+// extra bytes sent when a and b go out as one window
+static int32_t merge_penalty(Rect a, Rect b) {
+    return rect_cost(rect_union(a, b)) - rect_cost(a) - rect_cost(b);
+}
+
+// first and last changed column of a row, false when the row is unchanged
+static bool diff_row(const uint16_t *row, const uint16_t *previous_row, int16_t *x0, int16_t *x1) {
+    int first, last;
+    if (!diff_pixels(row, previous_row, SCREEN_WIDTH, &first, &last)) return false;
+
+    *x0 = first;
+    *x1 = last + 1;
+    return true;
+}
+
+// out of windows, merge the two neighbours that cost the least extra bytes
+static void merge_cheapest(Damage *damage) {
+    int best = 0;
+    int32_t best_penalty = INT32_MAX;
+
+    for (int i = 0; i < damage->count - 1; i++) {
+        int32_t penalty = merge_penalty(damage->rects[i], damage->rects[i + 1]);
+        if (penalty < best_penalty) {
+            best_penalty = penalty;
+            best = i;
+        }
+    }
+
+    damage->rects[best] = rect_union(damage->rects[best], damage->rects[best + 1]);
+    for (int i = best + 1; i < damage->count - 1; i++) damage->rects[i] = damage->rects[i + 1];
+    damage->count--;
+}
+
+void collect_damage(const uint16_t *frame, const uint16_t *previous, Damage *damage) {
+    damage->count = 0;
+    damage->copy_count = 0;
+
+    for (int16_t y = 0; y < SCREEN_HEIGHT; y++) {
+        Rect row;
+        if (!diff_row(&frame[y * SCREEN_WIDTH], &previous[y * SCREEN_WIDTH], &row.x0, &row.x1)) continue;
+        row.y0 = y;
+        row.y1 = y + 1;
+
+        if (damage->count > 0) {
+            Rect *last = &damage->rects[damage->count - 1];
+            if (merge_penalty(*last, row) <= 0) {
+                *last = rect_union(*last, row);
+                continue;
+            }
+        }
+
+        if (damage->count == MAX_DAMAGE_RECTS) merge_cheapest(damage);
+        damage->rects[damage->count++] = row;
+    }
+}
+
+// every row of r in frame equals the same row of previous moved dx columns to the left,
+// the columns that scrolled into view are not compared
+static bool is_moved(const uint16_t *frame, const uint16_t *previous, Rect r, int dx) {
+    int x_begin = dx > 0 ? r.x0 : r.x0 - dx;
+    int x_end = dx > 0 ? r.x1 - dx : r.x1;
+
+    for (int y = r.y0; y < r.y1; y++) {
+        const uint16_t *row = &frame[y * SCREEN_WIDTH];
+        const uint16_t *previous_row = &previous[y * SCREEN_WIDTH + dx];
+
+        if (!pixels_equal(&row[x_begin], &previous_row[x_begin], x_end - x_begin)) return false;
+    }
+    return true;
+}
+
+void find_panel_copies(const uint16_t *frame, const uint16_t *previous, Damage *damage) {
+    if (!PANEL_COPY_FITS) return;
+
+    for (int i = 0; i < damage->count; i++) {
+        Rect *r = &damage->rects[i];
+        int width = r->x1 - r->x0;
+
+        for (int step = 1; step <= MAX_COPY_DX && step < width; step++) {
+            int32_t saved = (int32_t)(width - step) * (r->y1 - r->y0) * sizeof(uint16_t);
+            if (saved <= MIN_COPY_SAVED_BYTES) break;
+
+            int dx = step;
+            if (!is_moved(frame, previous, *r, dx)) {
+                dx = -step;
+                if (!is_moved(frame, previous, *r, dx)) continue;
+            }
+
+            damage->copies[damage->copy_count++] = (Copy){*r, (int16_t)dx};
+
+            // only the columns that scrolled into view still have to be sent
+            if (dx > 0) {
+                r->x0 = r->x1 - dx;
+            } else {
+                r->x1 = r->x0 - dx;
+            }
+            break;
+        }
+    }
+}
+
+uint32_t damage_area(const Damage *damage) {
+    uint32_t area = 0;
+    for (int i = 0; i < damage->count; i++) area += rect_area(damage->rects[i]);
+    return area;
+}
+
+uint32_t damage_bytes(const Damage *damage) {
+    return damage->count * SSD1331_WINDOW_COMMAND_BYTES + damage->copy_count * SSD1331_COPY_COMMAND_BYTES +
+           damage_area(damage) * sizeof(uint16_t);
+}
@@ -12,15 +12,31 @@
 #include <Arduino.h>
 #include <SPI.h>
 
-#define SCREEN_WIDTH 96
-#define SCREEN_HEIGHT 64
-
-// define full circle so sine wave is seamless
-#define FULL_CIRCLE 360
+#include "damage.h"
+#include "bands.h"
+#include "ledscreen.h"
+#include "pacing.h"
+#include "palette.h"
+#include "pixels.h"
+#include "present.h"
+#include "profile.h"
+#include "quality.h"
+#include "scene.h"
+#include "scroll.h"
+#include "sine.h"
+#include "stream.h"
+#include "strips.h"
+#include "sun.h"
+#include "telemetry.h"
+#include "trees.h"
 
 // set communication speed to 115200 baud
 #define SERIAL_MONITOR_BAUD_RATE 115200  
 
+// send every frame as a delta over serial to tools/stream_viewer instead of the telemetry lines
+#define SERIAL_STREAM false
+#define SERIAL_STREAM_BAUD_RATE 921600
+
 // Define all SSD1331 pins
 #define DISPLAY_DIN 23
 #define DISPLAY_CLK 18
@@ -28,76 +44,103 @@
 #define DISPLAY_CS 5
 #define DISPLAY_RESET 17
 
-typedef struct {
-    uint8_t r;
-    uint8_t g;
-    uint8_t b;
-} Color;
-
-// Background layer settings
-typedef struct {
-    Color color;
-    float amplitude;
-    float frequency;
-    int pos_y;
-    float speed;
-    float darken_color;
-    float sin_lookup[FULL_CIRCLE];
-} Background;
-
-// Tree settings
-typedef struct {
-    int pos_x;
-    int pos_y;
-    float leaf1_shade;
-    float leaf2_shade;
-    float leaf3_shade;
-    int height;
-    int width;
-    int root_height;
-    int root_width;
-    int speed;
-} Tree;
-
-const Color sky = {138, 245, 255};
-const Color sun = {255, 255, 0};
-const Color tree_bark = {148, 108, 22};
-const Color grass = {42, 250, 0};
-const Color water = {0, 255, 255};
-const Color mountain = {97, 97, 96};
-const Color tree_leaf = {1, 97, 15};
+// send frame N on the transfer task while frame N+1 is rendered
+#define PRESENT_PIPELINED true
+
+// render the frame in horizontal bands, one worker per core, 0 renders on the loop() task
+#define RENDER_WORKERS 2
+
+// let the SSD1331 move scrolled pixels with its copy command instead of sending them again
+#define PANEL_COPY_SCROLL false
+
+// build and send the frame in strips with a hash per strip instead of two frame buffers, see strips.h,
+// strips render on the loop() task and need neither the frame buffers nor the previous frame
+#define STRIP_RENDER false
+
+static_assert(!(STRIP_RENDER && (SERIAL_STREAM || PANEL_COPY_SCROLL)), "the stream and panel copies need the full frame buffers");
+
+// frames start on a fixed 60 fps schedule, 0 renders as fast as possible
+#define TARGET_FPS 60
+
+// lower the detail step by step when frames do not fit the target anymore, 0 always renders full detail
+#define QUALITY_TARGET_FPS TARGET_FPS
+
+// share of the 16.6 ms frame every stage of loop() may take before telemetry flags it
+// render, diff, present, swap
+static const uint32_t stage_budget_us[FRAME_STAGE_COUNT] = {10000, 1000, 5000, 100};
+
+// colors of the built in scene, a scene flashed to the scene partition replaces them
+Color sky = {138, 245, 255};
+Color sun = {255, 255, 0};
+Color tree_bark = {148, 108, 22};
+Color tree_leaf = {1, 97, 15};
+
+static const Color grass = {42, 250, 0};
+static const Color water = {0, 255, 255};
+static const Color mountain = {97, 97, 96};
 
 // range of sun over the valley
-const float sun_range = 5000;
+#define BUILT_IN_SUN_RANGE 5000
+float sun_range = BUILT_IN_SUN_RANGE;
 
 // set all pins for the display and make object
 Adafruit_SSD1331 display = Adafruit_SSD1331(DISPLAY_CS, DISPLAY_DC, DISPLAY_DIN, DISPLAY_CLK, DISPLAY_RESET);
 
-// create 2 bitmap's for performance increase when writing to screen
-uint16_t old_bitmap[SCREEN_HEIGHT * SCREEN_WIDTH] = {};
-uint16_t bitmap[SCREEN_HEIGHT * SCREEN_WIDTH] = {};
-
-// all background levels defined in layers array
-int amount_of_layer = 0;
-Background layers[] = {
-    {.color = mountain, .amplitude = 7, .frequency = 17, .pos_y = 10, .speed = 0, .darken_color = 0.6},
-    {.color = mountain, .amplitude = 5, .frequency = 8, .pos_y = 15, .speed = 0.5, .darken_color = .8},
-    {.color = mountain, .amplitude = 4, .frequency = 5, .pos_y = 20, .speed = 1, .darken_color = 1},
-    {.color = grass, .amplitude = 5, .frequency = 4, .pos_y = 30, .speed = 3, .darken_color = 0.6},
-    {.color = grass, .amplitude = 3, .frequency = 3, .pos_y = 32, .speed = 6, .darken_color = 0.8},
-    {.color = grass, .amplitude = 3, .frequency = 2, .pos_y = 40, .speed = 16, .darken_color = 1},
-    {.color = water, .amplitude = 2, .frequency = 20, .pos_y = 60, .speed = 5, .darken_color = 0.6},
-    {.color = water, .amplitude = 2, .frequency = 20, .pos_y = 60, .speed = 10, .darken_color = 1}};
-
-// all trees defined in trees array
-int amount_of_trees = 0;
-Tree trees[] = {
+#if defined(ESP32)
+// two frame buffers of a larger panel and the sun glow do not fit next to the rest of the internal ram, render it in strips
+static_assert((STRIP_RENDER ? STRIP_MEMORY_BYTES : 2 * SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t)) + SUN_GLOW_MAX_PIXELS <= 64 * 1024,
+              "use STRIP_RENDER for this panel");
+#endif
+
+static_assert(!PANEL_COPY_SCROLL || PANEL_COPY_FITS, "the panel is too large to copy on");
+
+#if STRIP_RENDER
+// the strip renderer points bitmap at its own scratch strips
+uint16_t *bitmap = NULL;
+uint16_t *old_bitmap = NULL;
+#else
+// create 2 bitmap's for performance increase when writing to screen,
+// they trade places every frame so the last frame never has to be copied
+// word aligned so the pixel kernels can work on pairs from the first pixel of every row
+static uint16_t frame_buffers[2][SCREEN_HEIGHT * SCREEN_WIDTH] __attribute__((aligned(4))) = {};
+uint16_t *bitmap = frame_buffers[0];
+uint16_t *old_bitmap = frame_buffers[1];
+#endif
+int bitmap_first_row = 0;
+
+// a layer repeats its wave this many times every FULL_CIRCLE columns
+#define WAVES(n) sine_phase_step(n, FULL_CIRCLE)
+
+// background levels of the built in scene
+static const Background built_in_layers[] = {
+    {.color = mountain, .amplitude = 7, .frequency = WAVES(17), .pos_y = 10, .speed = 0, .darken_color = 0.6},
+    {.color = mountain, .amplitude = 5, .frequency = WAVES(8), .pos_y = 15, .speed = 0.5, .darken_color = .8},
+    {.color = mountain, .amplitude = 4, .frequency = WAVES(5), .pos_y = 20, .speed = 1, .darken_color = 1},
+    {.color = grass, .amplitude = 5, .frequency = WAVES(4), .pos_y = 30, .speed = 3, .darken_color = 0.6},
+    {.color = grass, .amplitude = 3, .frequency = WAVES(3), .pos_y = 32, .speed = 6, .darken_color = 0.8},
+    {.color = grass, .amplitude = 3, .frequency = WAVES(2), .pos_y = 40, .speed = 16, .darken_color = 1},
+    {.color = water, .amplitude = 2, .frequency = WAVES(20), .pos_y = 60, .speed = 5, .darken_color = 0.6},
+    {.color = water, .amplitude = 2, .frequency = WAVES(20), .pos_y = 60, .speed = 10, .darken_color = 1}};
+
+static_assert(sizeof(built_in_layers) / sizeof(built_in_layers[0]) <= MAX_LAYERS, "raise MAX_LAYERS");
+
+// trees of the built in scene
+static const Tree built_in_trees[] = {
     {.pos_x = 10, .pos_y = 25, .leaf1_shade = 1, .leaf2_shade = .6, .leaf3_shade = 1, .height = 10, .width = 5, .root_height = 7, .root_width = 3, .speed = 6},
     {.pos_x = 40, .pos_y = 27, .leaf1_shade = 1, .leaf2_shade = .6, .leaf3_shade = 1, .height = 10, .width = 5, .root_height = 7, .root_width = 3, .speed = 6},
     {.pos_x = 30, .pos_y = 30, .leaf1_shade = 1, .leaf2_shade = .6, .leaf3_shade = 1, .height = 10, .width = 5, .root_height = 7, .root_width = 3, .speed = 6},
     {.pos_x = 60, .pos_y = 33, .leaf1_shade = 1, .leaf2_shade = .6, .leaf3_shade = 1, .height = 10, .width = 5, .root_height = 7, .root_width = 3, .speed = 6},
     {.pos_x = 63, .pos_y = 35, .leaf1_shade = 1, .leaf2_shade = .6, .leaf3_shade = 1, .height = 10, .width = 5, .root_height = 7, .root_width = 3, .speed = 6}};
 
+static_assert(sizeof(built_in_trees) / sizeof(built_in_trees[0]) <= MAX_TREES, "raise MAX_TREES");
+
+// the scene being drawn
+int amount_of_layer = 0;
+Background layers[MAX_LAYERS];
+
+int amount_of_trees = 0;
+Tree trees[MAX_TREES];
+
 // darken a color 1 = no change, 0 = full black
 Color darken_color(Color c, float percentage) {
     c.r = c.r * percentage;
@@ -112,212 +155,174 @@ uint16_t color_to_hex(Color c) {
     return ((c.r >> 3) << 11) | ((c.g >> 2) << 5) | c.b >> 3;
 }
 
-// blend between colors based on percentage 0 = no blend, 1 full blend
-Color blend_color(Color color1, Color color2, float percentage) {
-    if (percentage < 0) percentage = 0;
-    if (percentage > 1) percentage = 1;
-
-    Color c;
-    c.r = (uint8_t)(color1.r * (1 - percentage) + color2.r * percentage);
-    c.g = (uint8_t)(color1.g * (1 - percentage) + color2.g * percentage);
-    c.b = (uint8_t)(color1.b * (1 - percentage) + color2.b * percentage);
-    return c;
-}
-
 // convert rgb888 to hex => rgb565
 uint16_t color_to_hex(uint8_t r, uint8_t g, uint8_t b) {
     return ((r >> 3) << 11) | ((g >> 2) << 5) | b >> 3;
 }
 
-// draw bitmap on screen ignore unchanged rows
-void render_screen(int unchanged_rows) {
-    uint16_t *offset_array = bitmap;
-    offset_array += SCREEN_WIDTH * unchanged_rows;
-
-    display.drawRGBBitmap(0, unchanged_rows, offset_array, SCREEN_WIDTH, SCREEN_HEIGHT - unchanged_rows);
-}
-
-// get time from boot in seconds
-double time_from_boot_in_sec() {
-    const double one_sec_to_miliseconds = 1000000;
-    return (double)esp_timer_get_time() / one_sec_to_miliseconds;
+// the built frame becomes the previous frame, the next frame is built in the other buffer
+void swap_frame_buffers() {
+    uint16_t *frame = bitmap;
+    bitmap = old_bitmap;
+    old_bitmap = frame;
 }
 
-// flush screen with one color
-void fill_screen_blank_color(Color color) {
-    for (size_t y = 0; y < SCREEN_HEIGHT; y++) {
-        for (size_t x = 0; x < SCREEN_WIDTH; x++) {
-            bitmap[y * SCREEN_WIDTH + x] = color_to_hex(color);
-        }
-    }
-}
+// state derived from the scene, rebuilt whenever the scene changes
+static void build_scene() {
+    reset_layer_strips();
 
-// this function takes the sin value from the lookup table and compares it with the y value of the screen
-// if true the function returns the layer color value with shade
-// if false the function returns the input color
-Color set_world_layer(Background layer, int x, int y, Color color, double time) {
-    int index = (x + (int)(time * layer.speed)) % (FULL_CIRCLE - 1);
+    // bake every color the renderer draws to rgb565
+    build_palette();
 
-    if (layer.sin_lookup[index] * layer.amplitude + layer.pos_y < y) {
-        return darken_color(layer.color, layer.darken_color);
-    }
+    // sun glow only depends on the pixel position
+    build_sun_overlay();
 
-    return color;
-}
+    // trees are drawn once, every frame only copies their pixels
+    build_tree_sprites();
 
-// loops over every background layer and draws the color on the bitmap
-// it also calculates the sun value over very pixel
-void build_world_layers(double time) {
-    for (size_t y = 0; y < SCREEN_HEIGHT; y++) {
-        for (size_t x = 0; x < SCREEN_WIDTH; x++) {
-            Color color = sky;
-
-            for (size_t i = 0; i < amount_of_layer; i++) {
-                int next_layer = i;
-
-                if (i < amount_of_layer - 1) {
-                    next_layer++;
-                } else if (layers[i].pos_y + layers[i].amplitude < y) {
-                    color = layers[i].color;
-                }
-
-                if (layers[i].pos_y - layers[i].amplitude <= y && layers[next_layer].pos_y + layers[next_layer].amplitude >= y) {
-                    color = set_world_layer(layers[i], x, y, color, time);
-                }
-            }
-
-            float sun_blend = (SCREEN_WIDTH - x) * (SCREEN_WIDTH - x) + y * y;
-            if (sun_blend < sun_range) {
-                float norm = sun_blend / sun_range;
-                float invert = 1 - norm;
-
-                float blend_curve = 1 - (invert * invert * invert * invert);
-                color = blend_color(sun, color, blend_curve);
-            }
-            bitmap[y * SCREEN_WIDTH + x] = color_to_hex(color);
-        }
-    }
+    // the hashes of the old scene say nothing about the new one
+    reset_strips();
 }
 
-// draw a triangle that looks like a leaf. from the tree object
-void make_leaf(Tree tree, int space, float shade) {
-    for (int y = 0; y < tree.height; y++) {
-        for (int x = tree.width - y + tree.width / 2; x <= tree.width + y - tree.width / 2; x++) {
-            Color color = darken_color(tree_leaf, shade);
+static void use_built_in_scene() {
+    amount_of_layer = sizeof(built_in_layers) / sizeof(built_in_layers[0]);
+    memcpy(layers, built_in_layers, sizeof(built_in_layers));
 
-            int adjusted_y = y + tree.pos_y + space;
-            int adjusted_x = x + tree.pos_x;
+    amount_of_trees = sizeof(built_in_trees) / sizeof(built_in_trees[0]);
+    memcpy(trees, built_in_trees, sizeof(built_in_trees));
 
-            bitmap[adjusted_y * SCREEN_WIDTH + adjusted_x % SCREEN_WIDTH] = color_to_hex(color);
-        }
+    // stretch the layers and move the trees over a larger panel, the trees keep their size
+    for (int i = 0; i < amount_of_layer; i++) {
+        layers[i].pos_y = layers[i].pos_y * SCREEN_HEIGHT / DESIGN_HEIGHT;
+        layers[i].amplitude = layers[i].amplitude * SCREEN_HEIGHT / DESIGN_HEIGHT;
     }
-}
-
-// plant tree in valley
-void tree(Tree tree, double time) {
-    tree.pos_x = tree.pos_x - (time * tree.speed);
-    int space = tree.height / 2;
-
-    for (size_t y = 0; y < tree.root_height; y++) {
-        for (size_t x = 0; x < tree.root_width; x++) {
-            int adjusted_y = y + tree.pos_y + tree.height + space;
-            int adjusted_x = x + (tree.width + tree.root_width) / 2 + tree.pos_x;
-
-            bitmap[adjusted_y * SCREEN_WIDTH + adjusted_x % SCREEN_WIDTH] = color_to_hex(tree_bark);
-        }
+    for (int i = 0; i < amount_of_trees; i++) {
+        trees[i].pos_x = trees[i].pos_x * SCREEN_WIDTH / DESIGN_WIDTH;
+        trees[i].pos_y = trees[i].pos_y * SCREEN_HEIGHT / DESIGN_HEIGHT;
     }
-
-    make_leaf(tree, -space, tree.leaf1_shade);
-    make_leaf(tree, 0, tree.leaf2_shade);
-    make_leaf(tree, space, tree.leaf3_shade);
+    sun_range = (float)BUILT_IN_SUN_RANGE * SCREEN_WIDTH / DESIGN_WIDTH * SCREEN_HEIGHT / DESIGN_HEIGHT;
 }
 
-void plant_trees(double time) {
-    for (size_t i = 0; i < amount_of_trees; i++) {
-        tree(trees[i], time);
+bool load_scene(const char *source) {
+    // decoded off the stack, the scene is copied into the render arrays
+    static Scene scene;
+
+    SceneResult result = read_scene(source, &scene);
+    if (result != SCENE_OK) {
+        Serial.print("Scene ");
+        Serial.print(source);
+        Serial.print(": ");
+        Serial.print(scene_result_name(result));
+        Serial.println(", keeping the current scene");
+        return false;
     }
-}
 
-// this function builds the sine wave tables for every background layer before hand.
-// sin is quite a heavy calculation witch slows the animation down
-// making a lookup table beforehand increases performance drastically
-void build_sin_table() {
-    for (size_t i = 0; i < amount_of_layer; i++) {
-        for (size_t y = 0; y < FULL_CIRCLE; y++) {
-            layers[i].sin_lookup[y] = sin(radians(y) * layers[i].frequency);
-        }
+    // the glow map has room for part of the panel only
+    if (sun_glow_pixels(scene.sun_range) > SUN_GLOW_MAX_PIXELS) {
+        Serial.print("Scene ");
+        Serial.print(source);
+        Serial.println(": sun_range reaches too much of the panel, keeping the current scene");
+        return false;
     }
-}
 
-// compares two frames (old and new bitmap) and returns the number of unchanged rows
-// unchanged rows are skipped during rendering to optimize render time
-int compare_bitmap_y_axis() {
-    for (size_t i = 0; i < SCREEN_HEIGHT; i++) {
-        bool same = true;
+    sky = scene.sky;
+    sun = scene.sun;
+    tree_bark = scene.tree_bark;
+    tree_leaf = scene.tree_leaf;
+    sun_range = scene.sun_range;
 
-        for (size_t x = 0; x < SCREEN_WIDTH; x++) {
-            if (bitmap[i * SCREEN_WIDTH + x] != old_bitmap[i * SCREEN_WIDTH + x]) {
-                same = false;
-                break;
-            }
-        }
+    amount_of_layer = scene.layer_count;
+    memcpy(layers, scene.layers, sizeof(layers));
+    amount_of_trees = scene.tree_count;
+    memcpy(trees, scene.trees, sizeof(trees));
 
-        if (!same) return i;
-    }
-    return SCREEN_HEIGHT;
+    build_scene();
+    return true;
+}
+
+// flush screen with one color
+void fill_screen_blank_color(uint16_t color) {
+    fill_pixels(bitmap, color, SCREEN_WIDTH * SCREEN_HEIGHT);
 }
 
 void setup() {
     display.begin();
-    Serial.begin(SERIAL_MONITOR_BAUD_RATE);
-
-    // clear screen
-    fill_screen_blank_color((Color){255, 255, 255});
-
-    // calculate int length of arrays;
-    amount_of_trees = sizeof(trees) / sizeof(trees[0]);
-    amount_of_layer = sizeof(layers) / sizeof(layers[0]);
-
-    // build lookup table for the sin function
-    build_sin_table();
-
-    Serial.println("Starting main render loop");
+    Serial.begin(SERIAL_STREAM ? SERIAL_STREAM_BAUD_RATE : SERIAL_MONITOR_BAUD_RATE);
+
+    // clear screen, the strip renderer sends every strip of its first frame instead
+    if (!STRIP_RENDER) fill_screen_blank_color(color_to_hex((Color){255, 255, 255}));
+
+    // a scene in the scene partition replaces the built in one without reflashing the firmware
+    use_built_in_scene();
+#if defined(ESP32)
+    if (!load_scene(SCENE_SOURCE)) build_scene();
+#else
+    build_scene();
+#endif
+
+    present_begin(&display, PRESENT_PIPELINED);
+    bands_begin(STRIP_RENDER ? 0 : RENDER_WORKERS);
+
+    // calibrate the cycle counter before the first frame is profiled
+    profile_begin();
+    pacing_begin(TARGET_FPS, stage_budget_us);
+    quality_begin(QUALITY_TARGET_FPS);
+    telemetry_begin(!SERIAL_STREAM);
+    if (SERIAL_STREAM) stream_begin();
+
+    if (!SERIAL_STREAM) Serial.println("Starting main render loop");
 }
 
 
 
 void loop() {
-    // get timing and fps so is displays the performance and fps
-    unsigned long timing = millis();
-    unsigned long fps = millis();
-
-    // get time in seconds from boot to make animation play
-    double time = time_from_boot_in_sec();
+    // sleep until the slot of this frame, the slot time drives the animation
+    int64_t slot = frame_begin();
+    double time = slot / 1000000.0;
+
+    if (STRIP_RENDER) {
+        // render, diff and present overlap strip by strip, the whole frame is timed as render
+        render_strips(time);
+        stage_end(FRAME_STAGE_RENDER);
+        profile_count(PROFILE_FRAMES, 1);
+
+        quality_update(frame_timing());
+        frame_end();
+        return;
+    }
 
-    Serial.print("Build world in: ");
+    // draw world layers and trees on screen, every band on its own core
+    render_bands(time);
+    stage_end(FRAME_STAGE_RENDER);
 
-    // draw world layers in order on screen
-    build_world_layers(time);
+    // world and trees are profiled inside render_bands()
+    uint32_t mark = profile_cycles();
 
-    // draw all trees on screen
-    plant_trees(time);
+    // find the windows that changed so unchanged pixels are not sent again
+    Damage damage;
+    collect_damage(bitmap, old_bitmap, &damage);
+    if (PANEL_COPY_SCROLL) find_panel_copies(bitmap, old_bitmap, &damage);
+    profile_stage_end(PROFILE_DIFF, &mark);
+    stage_end(FRAME_STAGE_DIFF);
 
-    Serial.print(millis() - timing);
-    Serial.print(" millis, Render in: ");
+    // render changed windows to screen, waits until the previous frame is sent
+    present_submit(bitmap, &damage);
+    if (SERIAL_STREAM) stream_submit(bitmap);
+    profile_stage_end(PROFILE_PRESENT, &mark);
+    stage_end(FRAME_STAGE_PRESENT);
 
-    // reset timing for rendering to screen
-    timing = millis();
+    // new bitmap becomes old bitmap, the panel keeps reading it while the next frame is built
+    swap_frame_buffers();
+    profile_stage_end(PROFILE_SWAP, &mark);
+    stage_end(FRAME_STAGE_SWAP);
 
-    // get the count of matching rows in the bitmap so it can ignore un-updated pixels
-    int rows_alike = compare_bitmap_y_axis();
-    
-    // render bitmap to screen
-    render_screen(rows_alike);
+    profile_count(PROFILE_FRAMES, 1);
+    profile_count(PROFILE_PIXELS_REWRITTEN, damage_area(&damage));
+    profile_count(PROFILE_SPI_BYTES, damage_bytes(&damage));
 
-    Serial.print(millis() - timing);
-    Serial.print(" millis, fps: ");
-    Serial.println(1000.0 / (float)(millis() - fps));
+    // the time this frame took picks the detail of the next frames
+    quality_update(frame_timing());
 
-    // copy new bitmap to old bitmap
-    memcpy(old_bitmap, bitmap, sizeof(old_bitmap));
-}
\ No newline at end of file
+    // timings are printed by the telemetry task, never from here
+    frame_end();
+}
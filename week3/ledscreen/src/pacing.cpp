@@ -0,0 +1,86 @@
+/*
+  Frame scheduler.
+
+  The deadline of the next frame advances by one period every frame, so a frame
+  that finishes early sleeps and a slow frame is caught up by the next ones.
+  When a frame starts more than a whole period late the schedule restarts from
+  now instead of rendering a burst of frames to catch up.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "pacing.h"
+
+#include "telemetry.h"
+
+// delay() sleeps in whole ticks of 1 ms, the last part of a wait is spun
+#define PACING_SPIN_US 1000
+
+const char *frame_stage_names[FRAME_STAGE_COUNT] = {"render", "diff", "present", "swap"};
+
+static struct {
+    int64_t period_us;
+    int64_t deadline_us;
+    int64_t mark_us;
+    uint32_t budget_us[FRAME_STAGE_COUNT];
+    uint32_t frame;
+    FrameTiming timing;
+} pacer;
+
+static void sleep_until(int64_t now, int64_t deadline) {
+    int64_t wait = deadline - now;
+    if (wait > PACING_SPIN_US) delay((wait - PACING_SPIN_US) / 1000);
+
+    while (esp_timer_get_time() < deadline) {
+    }
+}
+
+void pacing_begin(uint16_t target_fps, const uint32_t *stage_budget_us) {
+    pacer.period_us = target_fps > 0 ? 1000000 / target_fps : 0;
+    pacer.deadline_us = esp_timer_get_time();
+    memcpy(pacer.budget_us, stage_budget_us, sizeof(pacer.budget_us));
+}
+
+int64_t frame_begin() {
+    int64_t now = esp_timer_get_time();
+    int64_t slot = now;
+
+    pacer.timing = (FrameTiming){};
+    pacer.timing.frame = pacer.frame++;
+
+    if (pacer.period_us > 0) {
+        if (now < pacer.deadline_us) {
+            slot = pacer.deadline_us;
+            sleep_until(now, slot);
+            pacer.timing.idle_us = slot - now;
+        } else if (now - pacer.deadline_us >= pacer.period_us) {
+            // too far behind, start a new schedule instead of catching up
+            pacer.deadline_us = now;
+            pacer.timing.late = true;
+        } else {
+            slot = pacer.deadline_us;
+        }
+        pacer.deadline_us += pacer.period_us;
+    }
+
+    pacer.mark_us = slot > now ? slot : now;
+    return slot;
+}
+
+void stage_end(FrameStage stage) {
+    int64_t now = esp_timer_get_time();
+    uint32_t spent = now - pacer.mark_us;
+
+    pacer.timing.stage_us[stage] = spent;
+    if (spent > pacer.budget_us[stage]) pacer.timing.over_budget |= 1 << stage;
+    pacer.mark_us = now;
+}
+
+FrameTiming *frame_timing() {
+    return &pacer.timing;
+}
+
+void frame_end() {
+    telemetry_push(&pacer.timing);
+}
@@ -0,0 +1,27 @@
+/*
+  Bakes the scene colors to rgb565.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "palette.h"
+
+Palette palette = {};
+
+void build_palette() {
+    palette.sky = color_to_hex(sky);
+    palette.sun = color_to_hex(sun);
+    palette.tree_bark = color_to_hex(tree_bark);
+
+    for (int i = 0; i < amount_of_layer; i++) {
+        palette.layer_shade[i] = color_to_hex(darken_color(layers[i].color, layers[i].darken_color));
+        palette.layer_plain[i] = color_to_hex(layers[i].color);
+    }
+
+    for (int i = 0; i < amount_of_trees; i++) {
+        palette.leaf[i][0] = color_to_hex(darken_color(tree_leaf, trees[i].leaf1_shade));
+        palette.leaf[i][1] = color_to_hex(darken_color(tree_leaf, trees[i].leaf2_shade));
+        palette.leaf[i][2] = color_to_hex(darken_color(tree_leaf, trees[i].leaf3_shade));
+    }
+}
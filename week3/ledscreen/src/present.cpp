@@ -0,0 +1,194 @@
+/*
+  Present stage with an optional transfer task.
+
+  The ESP32 runs the transfer on a FreeRTOS task pinned to the other core, the
+  Adafruit SPI driver feeds the bus from there while loop() keeps rendering.
+  The host build runs the same hand over on a std::thread against the mock panel,
+  which can simulate the bus time of every transfer.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "present.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// the frame the transfer task is sending, only touched by loop() while idle
+static struct {
+    Adafruit_SSD1331 *display;
+    bool pipelined;
+    const uint16_t *frame;
+    int first_row;
+    Damage damage;
+} transfer;
+
+// let the panel move a window of pixels, coordinates are inclusive
+static void write_copy(Adafruit_SSD1331 *display, const Copy *copy) {
+    Rect r = copy->rect;
+    int source_x0 = copy->dx > 0 ? r.x0 + copy->dx : r.x0;
+    int source_x1 = copy->dx > 0 ? r.x1 : r.x1 + copy->dx;
+    int target_x0 = copy->dx > 0 ? r.x0 : r.x0 - copy->dx;
+
+    display->writeCommand(SSD1331_CMD_COPY);
+    display->writeCommand(source_x0);
+    display->writeCommand(r.y0);
+    display->writeCommand(source_x1 - 1);
+    display->writeCommand(r.y1 - 1);
+    display->writeCommand(target_x0);
+    display->writeCommand(r.y0);
+}
+
+void write_damage(Adafruit_SSD1331 *display, const uint16_t *frame, int first_row, const Damage *damage) {
+    if (damage->count == 0 && damage->copy_count == 0) return;
+
+    display->startWrite();
+    for (int i = 0; i < damage->copy_count; i++) write_copy(display, &damage->copies[i]);
+    if (damage->copy_count > 0) delayMicroseconds(SSD1331_COPY_SETTLE_US);
+
+    for (int i = 0; i < damage->count; i++) {
+        Rect r = damage->rects[i];
+        int width = r.x1 - r.x0;
+
+        display->setAddrWindow(r.x0, r.y0, width, r.y1 - r.y0);
+        for (int y = r.y0; y < r.y1; y++) {
+            display->writePixels((uint16_t *)&frame[(y - first_row) * SCREEN_WIDTH + r.x0], width);
+        }
+    }
+    display->endWrite();
+}
+
+#if defined(ESP32)
+
+// idle is given while no transfer is in flight, start wakes the transfer task
+static SemaphoreHandle_t transfer_idle;
+static SemaphoreHandle_t transfer_start;
+
+static void transfer_task(void *arg) {
+    for (;;) {
+        xSemaphoreTake(transfer_start, portMAX_DELAY);
+        write_damage(transfer.display, transfer.frame, transfer.first_row, &transfer.damage);
+        xSemaphoreGive(transfer_idle);
+    }
+}
+
+static void start_transfer_task() {
+    transfer_idle = xSemaphoreCreateBinary();
+    transfer_start = xSemaphoreCreateBinary();
+    xSemaphoreGive(transfer_idle);
+
+    xTaskCreatePinnedToCore(transfer_task, "present", PRESENT_TASK_STACK_SIZE, NULL, PRESENT_TASK_PRIORITY, NULL, PRESENT_TASK_CORE);
+}
+
+static void wait_idle() {
+    xSemaphoreTake(transfer_idle, portMAX_DELAY);
+}
+
+static void release_idle() {
+    xSemaphoreGive(transfer_idle);
+}
+
+static void kick_transfer() {
+    xSemaphoreGive(transfer_start);
+}
+
+bool present_ready() {
+    return !transfer.pipelined || uxSemaphoreGetCount(transfer_idle) > 0;
+}
+
+#else
+
+// never destroyed, the detached transfer thread still waits on them when the program exits
+static std::mutex &transfer_mutex = *new std::mutex;
+static std::condition_variable &transfer_changed = *new std::condition_variable;
+static bool transfer_busy = false;
+
+static void transfer_task() {
+    std::unique_lock<std::mutex> lock(transfer_mutex);
+    for (;;) {
+        transfer_changed.wait(lock, [] { return transfer_busy; });
+
+        lock.unlock();
+        write_damage(transfer.display, transfer.frame, transfer.first_row, &transfer.damage);
+        lock.lock();
+
+        transfer_busy = false;
+        transfer_changed.notify_all();
+    }
+}
+
+static void start_transfer_task() {
+    std::thread(transfer_task).detach();
+}
+
+static void wait_idle() {
+    std::unique_lock<std::mutex> lock(transfer_mutex);
+    transfer_changed.wait(lock, [] { return !transfer_busy; });
+}
+
+static void release_idle() {}
+
+static void kick_transfer() {
+    std::lock_guard<std::mutex> lock(transfer_mutex);
+    transfer_busy = true;
+    transfer_changed.notify_all();
+}
+
+bool present_ready() {
+    std::lock_guard<std::mutex> lock(transfer_mutex);
+    return !transfer_busy;
+}
+
+#endif
+
+void present_begin(Adafruit_SSD1331 *display, bool pipelined) {
+    static bool task_started = false;
+
+    present_wait();
+    transfer.display = display;
+    transfer.pipelined = pipelined;
+
+    if (pipelined && !task_started) {
+        start_transfer_task();
+        task_started = true;
+    }
+}
+
+static void submit(const uint16_t *frame, int first_row, const Damage *damage) {
+    if (!transfer.pipelined) {
+        write_damage(transfer.display, frame, first_row, damage);
+        return;
+    }
+
+    wait_idle();
+    transfer.frame = frame;
+    transfer.first_row = first_row;
+    transfer.damage = *damage;
+    kick_transfer();
+}
+
+void present_submit(const uint16_t *frame, const Damage *damage) {
+    submit(frame, 0, damage);
+}
+
+void present_submit_rows(const uint16_t *rows, int y_begin, int y_end) {
+    Damage damage = {};
+    damage.rects[0] = (Rect){0, (int16_t)y_begin, SCREEN_WIDTH, (int16_t)y_end};
+    damage.count = 1;
+    submit(rows, y_begin, &damage);
+}
+
+void present_wait() {
+    if (!transfer.pipelined) return;
+
+    wait_idle();
+    release_idle();
+}
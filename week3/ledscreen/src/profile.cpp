@@ -0,0 +1,210 @@
+/*
+  Fixed memory stage histograms.
+
+  A duration of v cycles lands in the bucket of its highest set bit, split in
+  PROFILE_SUB_BUCKETS by the bits below it. 240 buckets cover all 32 bit values,
+  so a histogram is under 1 KB and recording is a few shifts and an increment.
+
+  loop() and the band workers record while the telemetry task dumps or resets,
+  so every access to the histograms and counters holds a short lock.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "profile.h"
+
+#include <stdio.h>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#else
+#include <mutex>
+#endif
+
+const char *profile_stage_names[PROFILE_STAGE_COUNT] = {"world", "trees", "diff", "present", "swap"};
+const char *profile_counter_names[PROFILE_COUNTER_COUNT] = {"frames", "pixels_rewritten", "spi_bytes"};
+
+typedef struct {
+    uint32_t buckets[PROFILE_HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} Histogram;
+
+static Histogram histograms[PROFILE_STAGE_COUNT];
+static uint64_t counters[PROFILE_COUNTER_COUNT];
+static uint32_t cycles_per_mhz = 1;
+
+#if defined(ESP32)
+
+// a spinlock, the writers run on both cores
+static portMUX_TYPE profile_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void lock_profile() {
+    portENTER_CRITICAL(&profile_mux);
+}
+
+static void unlock_profile() {
+    portEXIT_CRITICAL(&profile_mux);
+}
+
+#else
+
+// never destroyed, detached threads may still record when the program exits
+static std::mutex &profile_mutex = *new std::mutex;
+
+static void lock_profile() {
+    profile_mutex.lock();
+}
+
+static void unlock_profile() {
+    profile_mutex.unlock();
+}
+
+#endif
+
+static int bucket_of(uint32_t cycles) {
+    if (cycles < PROFILE_SUB_BUCKETS) return cycles;
+
+    int exponent = 31 - __builtin_clz(cycles);
+    int shift = exponent - PROFILE_SUB_BUCKET_BITS;
+    int sub = (cycles >> shift) & (PROFILE_SUB_BUCKETS - 1);
+    return (shift + 1) * PROFILE_SUB_BUCKETS + sub;
+}
+
+// largest value that lands in bucket
+static uint32_t bucket_top(int bucket) {
+    if (bucket < PROFILE_SUB_BUCKETS) return bucket;
+
+    int shift = bucket / PROFILE_SUB_BUCKETS - 1;
+    int sub = bucket % PROFILE_SUB_BUCKETS;
+    uint64_t bottom = (uint64_t)(PROFILE_SUB_BUCKETS + sub) << shift;
+    return (uint32_t)(bottom + ((uint64_t)1 << shift) - 1);
+}
+
+// smallest bucket top with at least fraction of the samples at or below it
+static uint32_t histogram_percentile(const Histogram *h, uint32_t per_mille) {
+    uint32_t rank = ((uint64_t)h->count * per_mille + 999) / 1000;
+    if (rank == 0) rank = 1;
+
+    uint32_t seen = 0;
+    for (int i = 0; i < PROFILE_HISTOGRAM_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) return bucket_top(i) < h->max ? bucket_top(i) : h->max;
+    }
+    return h->max;
+}
+
+void profile_reset() {
+    lock_profile();
+    memset(histograms, 0, sizeof(histograms));
+    memset(counters, 0, sizeof(counters));
+    unlock_profile();
+}
+
+void profile_begin() {
+    int64_t start_us = esp_timer_get_time();
+    uint32_t start_cycles = profile_cycles();
+    delay(PROFILE_CALIBRATION_MS);
+    uint32_t cycles = profile_cycles() - start_cycles;
+    int64_t us = esp_timer_get_time() - start_us;
+
+    cycles_per_mhz = (cycles + us / 2) / us;
+    if (cycles_per_mhz == 0) cycles_per_mhz = 1;
+
+    profile_reset();
+}
+
+void profile_record(ProfileStage stage, uint32_t cycles) {
+    Histogram *h = &histograms[stage];
+    int bucket = bucket_of(cycles);
+
+    lock_profile();
+    h->buckets[bucket]++;
+    if (h->count == 0 || cycles < h->min) h->min = cycles;
+    if (cycles > h->max) h->max = cycles;
+    h->total += cycles;
+    h->count++;
+    unlock_profile();
+}
+
+void profile_count(ProfileCounter counter, uint32_t amount) {
+    lock_profile();
+    counters[counter] += amount;
+    unlock_profile();
+}
+
+// call with the lock held
+static ProfileStats histogram_stats(const Histogram *h) {
+    ProfileStats stats = {};
+    if (h->count == 0) return stats;
+
+    stats.count = h->count;
+    stats.min = h->min;
+    stats.p50 = histogram_percentile(h, 500);
+    stats.p99 = histogram_percentile(h, 990);
+    stats.max = h->max;
+    stats.total = h->total;
+    return stats;
+}
+
+ProfileStats profile_stats(ProfileStage stage) {
+    lock_profile();
+    ProfileStats stats = histogram_stats(&histograms[stage]);
+    unlock_profile();
+    return stats;
+}
+
+uint64_t profile_counter(ProfileCounter counter) {
+    lock_profile();
+    uint64_t value = counters[counter];
+    unlock_profile();
+    return value;
+}
+
+uint32_t profile_cycles_per_mhz() {
+    return cycles_per_mhz;
+}
+
+int profile_write_csv(char *buffer, size_t size) {
+    // formatted from a snapshot so the lock is not held during snprintf
+    ProfileSnapshot snapshot;
+    profile_snapshot(&snapshot);
+
+    int length = snprintf(buffer, size, "name,count,min_us,p50_us,p99_us,max_us,total\n");
+    double us = snapshot.cycles_per_mhz;
+
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++) {
+        ProfileStats stats = snapshot.stages[s];
+        size_t used = (size_t)length < size ? length : size;
+
+        length += snprintf(buffer + used, size - used, "%s,%u,%.2f,%.2f,%.2f,%.2f,%.0f\n", profile_stage_names[s],
+                           (unsigned)stats.count, stats.min / us, stats.p50 / us, stats.p99 / us, stats.max / us, stats.total / us);
+    }
+
+    // counters have no distribution, count is the number of frames
+    for (int c = 0; c < PROFILE_COUNTER_COUNT; c++) {
+        size_t used = (size_t)length < size ? length : size;
+
+        length += snprintf(buffer + used, size - used, "%s,%llu,,,,,%llu\n", profile_counter_names[c],
+                           (unsigned long long)snapshot.counters[PROFILE_FRAMES], (unsigned long long)snapshot.counters[c]);
+    }
+    return length;
+}
+
+void profile_snapshot(ProfileSnapshot *snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->magic = PROFILE_SNAPSHOT_MAGIC;
+    snapshot->version = PROFILE_SNAPSHOT_VERSION;
+    snapshot->stage_count = PROFILE_STAGE_COUNT;
+    snapshot->counter_count = PROFILE_COUNTER_COUNT;
+    snapshot->cycles_per_mhz = cycles_per_mhz;
+
+    // all stages and counters from the same moment
+    lock_profile();
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++) snapshot->stages[s] = histogram_stats(&histograms[s]);
+    memcpy(snapshot->counters, counters, sizeof(counters));
+    unlock_profile();
+}
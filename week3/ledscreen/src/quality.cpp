@@ -0,0 +1,115 @@
+/*
+  Adaptive level of detail.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "quality.h"
+
+const char *quality_level_names[QUALITY_LEVEL_COUNT] = {"full", "hold far layers", "no sun", "half width"};
+
+static struct {
+    uint32_t period_us;
+    QualityLevel level;
+    QualityLevel forced;
+    uint32_t frame;
+    // running average of the frame time, 0 starts it again from the next frame
+    uint32_t average_us;
+    uint32_t slow_frames;
+    uint32_t fast_frames;
+    uint32_t restore_frames;
+    // frame of the last restore, only valid when restored is set
+    uint32_t restored_at;
+    bool restored;
+    uint32_t far_layer_frames;
+    double far_layer_time;
+} quality = {0, QUALITY_FULL, QUALITY_LEVEL_COUNT, 0, 0, 0, 0, QUALITY_RESTORE_FRAMES, 0, false, 0, 0};
+
+void quality_begin(uint16_t target_fps) {
+    quality.period_us = target_fps > 0 ? 1000000 / target_fps : 0;
+    quality.level = QUALITY_FULL;
+    quality.average_us = 0;
+    quality.slow_frames = 0;
+    quality.fast_frames = 0;
+    quality.restore_frames = QUALITY_RESTORE_FRAMES;
+    quality.restored = false;
+}
+
+QualityLevel quality_level() {
+    return quality.forced < QUALITY_LEVEL_COUNT ? quality.forced : quality.level;
+}
+
+void quality_force(QualityLevel level) {
+    quality.forced = level;
+}
+
+static void degrade() {
+    if (quality.level == QUALITY_LEVEL_COUNT - 1) return;
+
+    // the level that came back could not be held, try it again later,
+    // a degrade without a restore before it has nothing to back off from
+    if (quality.restored) {
+        uint32_t since_restore = quality.frame - quality.restored_at;
+        if (since_restore < quality.restore_frames) {
+            quality.restore_frames = quality.restore_frames * 2 < QUALITY_MAX_RESTORE_FRAMES ? quality.restore_frames * 2 : QUALITY_MAX_RESTORE_FRAMES;
+        } else if (since_restore >= QUALITY_MAX_RESTORE_FRAMES) {
+            quality.restore_frames = QUALITY_RESTORE_FRAMES;
+        }
+        quality.restored = false;
+    }
+
+    quality.level = (QualityLevel)(quality.level + 1);
+}
+
+static void restore() {
+    if (quality.level == QUALITY_FULL) return;
+
+    quality.level = (QualityLevel)(quality.level - 1);
+    quality.restored_at = quality.frame;
+    quality.restored = true;
+}
+
+void quality_update(FrameTiming *timing) {
+    timing->quality = quality_level();
+    quality.frame++;
+    if (quality.period_us == 0) return;
+
+    uint32_t busy_us = 0;
+    for (int s = 0; s < FRAME_STAGE_COUNT; s++) busy_us += timing->stage_us[s];
+
+    if (quality.average_us == 0) {
+        quality.average_us = busy_us > 0 ? busy_us : 1;
+    } else {
+        quality.average_us += ((int32_t)busy_us - (int32_t)quality.average_us) >> QUALITY_AVERAGE_SHIFT;
+    }
+
+    bool slow = timing->late || quality.average_us * 100 > quality.period_us * QUALITY_DEGRADE_PERCENT;
+    bool fast = !timing->late && quality.average_us * 100 < quality.period_us * QUALITY_RESTORE_PERCENT;
+
+    quality.slow_frames = slow ? quality.slow_frames + 1 : 0;
+    quality.fast_frames = fast ? quality.fast_frames + 1 : 0;
+
+    if (quality.slow_frames < QUALITY_DEGRADE_FRAMES && quality.fast_frames < quality.restore_frames) return;
+
+    if (quality.slow_frames > 0) {
+        degrade();
+    } else {
+        restore();
+    }
+
+    // the frames of the old level say nothing about the new one
+    quality.average_us = 0;
+    quality.slow_frames = 0;
+    quality.fast_frames = 0;
+}
+
+double quality_far_layer_time(double time) {
+    if (quality_level() < QUALITY_HOLD_FAR_LAYERS || quality.far_layer_frames == 0) {
+        quality.far_layer_time = time;
+        quality.far_layer_frames = QUALITY_FAR_LAYER_FRAMES;
+    }
+
+    quality.far_layer_frames--;
+    return quality.far_layer_time;
+}
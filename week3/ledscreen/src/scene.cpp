@@ -0,0 +1,277 @@
+/*
+  Scene decoding and encoding, and mapping the scene from flash or a file.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "scene.h"
+
+#include "sine.h"
+#include "trees.h"
+
+#if defined(ESP32)
+#include <esp_partition.h>
+#include <esp_spi_flash.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+
+static uint16_t get_u16(const uint8_t *p) {
+    return p[0] | p[1] << 8;
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static float get_f32(const uint8_t *p) {
+    uint32_t bits = get_u32(p);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static Color get_color(const uint8_t *p) {
+    return (Color){p[0], p[1], p[2]};
+}
+
+static void put_u16(uint8_t *p, uint16_t value) {
+    p[0] = value;
+    p[1] = value >> 8;
+}
+
+static void put_u32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++) p[i] = value >> (8 * i);
+}
+
+static void put_f32(uint8_t *p, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_u32(p, bits);
+}
+
+static void put_color(uint8_t *p, Color c) {
+    p[0] = c.r;
+    p[1] = c.g;
+    p[2] = c.b;
+}
+
+// fnv-1a of the whole file with the checksum field left out
+static uint32_t scene_checksum(const uint8_t *data, size_t size) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < size; i++) {
+        if (i >= SCENE_AT_CHECKSUM && i < SCENE_AT_CHECKSUM + 4) continue;
+        hash = (hash ^ data[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+static bool is_in_range(float value, float low, float high) {
+    // false for NaN as well
+    return value >= low && value <= high;
+}
+
+static bool layer_values_ok(const uint8_t *p) {
+    return is_in_range(get_f32(p + 8), 0, SCENE_MAX_WAVES) && is_in_range(get_f32(p + 12), -SCENE_MAX_SPEED, SCENE_MAX_SPEED) &&
+           is_in_range(get_f32(p + 16), 0, 1);
+}
+
+static bool tree_values_ok(const uint8_t *p) {
+    for (int i = 0; i < 3; i++) {
+        if (!is_in_range(get_f32(p + 4 + 4 * i), 0, 1)) return false;
+    }
+
+    Tree tree = {};
+    tree.height = p[16];
+    tree.width = p[17];
+    tree.root_height = p[18];
+    tree.root_width = p[19];
+
+    int columns, rows;
+    tree_sprite_extent(&tree, &columns, &rows);
+    return columns <= SPRITE_CANVAS_SIZE && rows <= SPRITE_CANVAS_SIZE;
+}
+
+static void decode_layer(const uint8_t *p, Background *layer) {
+    layer->color = get_color(p);
+    layer->amplitude = (int8_t)p[3];
+    layer->pos_y = (int16_t)get_u16(p + 4);
+    layer->frequency = sine_phase_step(get_f32(p + 8), FULL_CIRCLE);
+    layer->speed = get_f32(p + 12);
+    layer->darken_color = get_f32(p + 16);
+}
+
+static void decode_tree(const uint8_t *p, Tree *tree) {
+    tree->pos_x = (int16_t)get_u16(p);
+    tree->pos_y = (int16_t)get_u16(p + 2);
+    tree->leaf1_shade = get_f32(p + 4);
+    tree->leaf2_shade = get_f32(p + 8);
+    tree->leaf3_shade = get_f32(p + 12);
+    tree->height = p[16];
+    tree->width = p[17];
+    tree->root_height = p[18];
+    tree->root_width = p[19];
+    tree->speed = (int16_t)get_u16(p + 20);
+}
+
+SceneResult decode_scene(const uint8_t *data, size_t size, Scene *scene) {
+    if (size < SCENE_HEADER_SIZE) return SCENE_TRUNCATED;
+    if (get_u32(data + SCENE_AT_MAGIC) != SCENE_MAGIC) return SCENE_BAD_MAGIC;
+    if (get_u16(data + SCENE_AT_VERSION) > SCENE_VERSION) return SCENE_BAD_VERSION;
+
+    size_t header_size = get_u16(data + SCENE_AT_HEADER_SIZE);
+    int layer_count = data[SCENE_AT_LAYER_COUNT];
+    int tree_count = data[SCENE_AT_TREE_COUNT];
+    size_t layer_size = data[SCENE_AT_LAYER_RECORD_SIZE];
+    size_t tree_size = data[SCENE_AT_TREE_RECORD_SIZE];
+
+    if (header_size < SCENE_HEADER_SIZE || layer_size < SCENE_LAYER_RECORD_SIZE || tree_size < SCENE_TREE_RECORD_SIZE) {
+        return SCENE_BAD_VERSION;
+    }
+    if (layer_count > MAX_LAYERS || tree_count > MAX_TREES) return SCENE_TOO_MANY;
+
+    size_t file_size = header_size + layer_count * layer_size + tree_count * tree_size;
+    if (size < file_size) return SCENE_TRUNCATED;
+    if (scene_checksum(data, file_size) != get_u32(data + SCENE_AT_CHECKSUM)) return SCENE_BAD_CHECKSUM;
+
+    // every value is checked before the first one is written to scene
+    const uint8_t *records = data + header_size;
+    if (!is_in_range(get_f32(data + SCENE_AT_SUN_RANGE), 0, INFINITY)) return SCENE_BAD_VALUE;
+    for (int i = 0; i < layer_count; i++) {
+        if (!layer_values_ok(records + i * layer_size)) return SCENE_BAD_VALUE;
+    }
+    for (int i = 0; i < tree_count; i++) {
+        if (!tree_values_ok(records + layer_count * layer_size + i * tree_size)) return SCENE_BAD_VALUE;
+    }
+
+    scene->sky = get_color(data + SCENE_AT_SKY);
+    scene->sun = get_color(data + SCENE_AT_SUN);
+    scene->tree_bark = get_color(data + SCENE_AT_TREE_BARK);
+    scene->tree_leaf = get_color(data + SCENE_AT_TREE_LEAF);
+    scene->sun_range = get_f32(data + SCENE_AT_SUN_RANGE);
+
+    const uint8_t *record = records;
+    scene->layer_count = layer_count;
+    for (int i = 0; i < layer_count; i++, record += layer_size) decode_layer(record, &scene->layers[i]);
+
+    scene->tree_count = tree_count;
+    for (int i = 0; i < tree_count; i++, record += tree_size) decode_tree(record, &scene->trees[i]);
+
+    return SCENE_OK;
+}
+
+size_t encode_scene(const Scene *scene, uint8_t *data, size_t size) {
+    size_t file_size = SCENE_HEADER_SIZE + scene->layer_count * SCENE_LAYER_RECORD_SIZE + scene->tree_count * SCENE_TREE_RECORD_SIZE;
+    if (file_size > size) return 0;
+    memset(data, 0, file_size);
+
+    put_u32(data + SCENE_AT_MAGIC, SCENE_MAGIC);
+    put_u16(data + SCENE_AT_VERSION, SCENE_VERSION);
+    put_u16(data + SCENE_AT_HEADER_SIZE, SCENE_HEADER_SIZE);
+    data[SCENE_AT_LAYER_COUNT] = scene->layer_count;
+    data[SCENE_AT_TREE_COUNT] = scene->tree_count;
+    data[SCENE_AT_LAYER_RECORD_SIZE] = SCENE_LAYER_RECORD_SIZE;
+    data[SCENE_AT_TREE_RECORD_SIZE] = SCENE_TREE_RECORD_SIZE;
+    put_color(data + SCENE_AT_SKY, scene->sky);
+    put_color(data + SCENE_AT_SUN, scene->sun);
+    put_color(data + SCENE_AT_TREE_BARK, scene->tree_bark);
+    put_color(data + SCENE_AT_TREE_LEAF, scene->tree_leaf);
+    put_f32(data + SCENE_AT_SUN_RANGE, scene->sun_range);
+
+    uint8_t *p = data + SCENE_HEADER_SIZE;
+    for (int i = 0; i < scene->layer_count; i++, p += SCENE_LAYER_RECORD_SIZE) {
+        const Background *layer = &scene->layers[i];
+        put_color(p, layer->color);
+        p[3] = (int8_t)layer->amplitude;
+        put_u16(p + 4, (int16_t)layer->pos_y);
+        put_f32(p + 8, (float)((double)layer->frequency * FULL_CIRCLE / 4294967296.0));
+        put_f32(p + 12, layer->speed);
+        put_f32(p + 16, layer->darken_color);
+    }
+
+    for (int i = 0; i < scene->tree_count; i++, p += SCENE_TREE_RECORD_SIZE) {
+        const Tree *tree = &scene->trees[i];
+        put_u16(p, (int16_t)tree->pos_x);
+        put_u16(p + 2, (int16_t)tree->pos_y);
+        put_f32(p + 4, tree->leaf1_shade);
+        put_f32(p + 8, tree->leaf2_shade);
+        put_f32(p + 12, tree->leaf3_shade);
+        p[16] = tree->height;
+        p[17] = tree->width;
+        p[18] = tree->root_height;
+        p[19] = tree->root_width;
+        put_u16(p + 20, (int16_t)tree->speed);
+    }
+
+    put_u32(data + SCENE_AT_CHECKSUM, scene_checksum(data, file_size));
+    return file_size;
+}
+
+#if defined(ESP32)
+
+SceneResult read_scene(const char *source, Scene *scene) {
+    const esp_partition_t *partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)SCENE_PARTITION_SUBTYPE, source);
+    if (partition == NULL) return SCENE_MISSING;
+
+    const void *data;
+    spi_flash_mmap_handle_t handle;
+    if (esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA, &data, &handle) != ESP_OK) return SCENE_MISSING;
+
+    // an erased partition reads 0xFF and fails on the magic
+    SceneResult result = decode_scene((const uint8_t *)data, partition->size, scene);
+    spi_flash_munmap(handle);
+    return result;
+}
+
+#else
+
+SceneResult read_scene(const char *source, Scene *scene) {
+    int file = open(source, O_RDONLY);
+    if (file < 0) return SCENE_MISSING;
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size == 0) {
+        close(file);
+        return SCENE_TRUNCATED;
+    }
+
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) return SCENE_MISSING;
+
+    SceneResult result = decode_scene((const uint8_t *)data, info.st_size, scene);
+    munmap(data, info.st_size);
+    return result;
+}
+
+#endif
+
+const char *scene_result_name(SceneResult result) {
+    switch (result) {
+        case SCENE_OK:
+            return "ok";
+        case SCENE_MISSING:
+            return "not found";
+        case SCENE_TRUNCATED:
+            return "truncated";
+        case SCENE_BAD_MAGIC:
+            return "not a scene";
+        case SCENE_BAD_VERSION:
+            return "unsupported version";
+        case SCENE_TOO_MANY:
+            return "too many layers or trees";
+        case SCENE_BAD_CHECKSUM:
+            return "checksum mismatch";
+        case SCENE_BAD_VALUE:
+            return "value out of range";
+    }
+    return "unknown";
+}
@@ -0,0 +1,60 @@
+/*
+  Ring buffer of layer surface rows.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "scroll.h"
+
+#include "sine.h"
+
+LayerStrip layer_strips[MAX_LAYERS] = {};
+uint32_t strip_columns_computed = 0;
+
+void reset_layer_strips() {
+    for (int i = 0; i < MAX_LAYERS; i++) layer_strips[i].valid = false;
+}
+
+// first row below the wave at lookup index u, the phase wraps so negative u and the seam need no care
+static uint8_t wave_begin_at(const Background *layer, int u) {
+    int32_t wave = (int32_t)sine_at((uint32_t)u * layer->frequency) * layer->amplitude;
+    int row = (wave >> SINE_SHIFT) + layer->pos_y + 1;
+
+    if (row < 0) return 0;
+    if (row > SCREEN_HEIGHT) return SCREEN_HEIGHT;
+    return row;
+}
+
+static void fill_strip(LayerStrip *strip, const Background *layer, int u_begin, int u_end) {
+    for (int u = u_begin; u < u_end; u++) {
+        strip->wave_begin[strip_slot(u)] = wave_begin_at(layer, u);
+    }
+    strip_columns_computed += u_end - u_begin;
+}
+
+int advance_layer_strip(int i, int offset) {
+    LayerStrip *strip = &layer_strips[i];
+    const Background *layer = &layers[i];
+
+    int moved = offset - strip->offset;
+    if (strip->valid && moved == 0) return 0;
+
+    // too far or nothing cached, the whole strip comes into view
+    if (!strip->valid || moved >= SCREEN_WIDTH || moved <= -SCREEN_WIDTH) {
+        strip->offset = offset;
+        strip->valid = true;
+        fill_strip(strip, layer, offset, offset + SCREEN_WIDTH);
+        return SCREEN_WIDTH;
+    }
+
+    // the slots of the columns that scrolled out are reused for the ones that scrolled in
+    if (moved > 0) {
+        fill_strip(strip, layer, strip->offset + SCREEN_WIDTH, offset + SCREEN_WIDTH);
+    } else {
+        fill_strip(strip, layer, offset, strip->offset);
+    }
+
+    strip->offset = offset;
+    return moved > 0 ? moved : -moved;
+}
@@ -0,0 +1,35 @@
+/*
+  Compile time quarter wave table.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "sine.h"
+
+#define SINE_PI 3.14159265358979323846
+
+// taylor series, accurate to well below one Q14 step on [0, pi / 2]
+static constexpr double taylor_sin(double x) {
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+static constexpr SineTable build_sine_table() {
+    SineTable table = {};
+    for (int i = 0; i <= SINE_QUARTER; i++) {
+        table.quarter[i] = (int16_t)(taylor_sin(i * (SINE_PI / 2) / SINE_QUARTER) * SINE_ONE + 0.5);
+    }
+    return table;
+}
+
+// constant initialized, so the ESP32 keeps it in flash
+constexpr SineTable sine_table = build_sine_table();
+
+static_assert(sine_table.quarter[0] == 0, "sine table does not start at 0");
+static_assert(sine_table.quarter[SINE_QUARTER] == SINE_ONE, "sine table does not end at 1.0");
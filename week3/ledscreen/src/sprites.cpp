@@ -0,0 +1,113 @@
+/*
+  Sprite packing and blitting.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "sprites.h"
+
+#include "pixels.h"
+
+static Sprite sprites[MAX_SPRITES];
+static SpriteRun sprite_runs[SPRITE_RUN_POOL];
+static uint16_t sprite_pixels[SPRITE_PIXEL_POOL];
+
+static int sprite_count = 0;
+static int run_count = 0;
+static int pixel_count = 0;
+
+void reset_sprites() {
+    sprite_count = 0;
+    run_count = 0;
+    pixel_count = 0;
+}
+
+void clear_sprite_canvas(SpriteCanvas *canvas, int x0, int y0) {
+    canvas->x0 = x0;
+    canvas->y0 = y0;
+    memset(canvas->mask, 0, sizeof(canvas->mask));
+}
+
+void sprite_canvas_pixel(SpriteCanvas *canvas, int x, int y, uint16_t color) {
+    x -= canvas->x0;
+    y -= canvas->y0;
+    if (x < 0 || x >= SPRITE_CANVAS_SIZE || y < 0 || y >= SPRITE_CANVAS_SIZE) return;
+
+    canvas->pixels[y * SPRITE_CANVAS_SIZE + x] = color;
+    canvas->mask[y * SPRITE_CANVAS_SIZE + x] = true;
+}
+
+int build_sprite(const SpriteCanvas *canvas) {
+    if (sprite_count == MAX_SPRITES) return -1;
+
+    Sprite *sprite = &sprites[sprite_count];
+    sprite->x0 = canvas->x0;
+    sprite->y0 = canvas->y0;
+    sprite->first_run = run_count;
+
+    int runs = run_count;
+    int pixels = pixel_count;
+
+    for (int y = 0; y < SPRITE_CANVAS_SIZE; y++) {
+        const bool *mask = &canvas->mask[y * SPRITE_CANVAS_SIZE];
+
+        for (int x = 0; x < SPRITE_CANVAS_SIZE;) {
+            if (!mask[x]) {
+                x++;
+                continue;
+            }
+
+            int length = 0;
+            while (x + length < SPRITE_CANVAS_SIZE && mask[x + length]) length++;
+            if (runs == SPRITE_RUN_POOL || pixels + length > SPRITE_PIXEL_POOL) return -1;
+
+            sprite_runs[runs++] = (SpriteRun){(uint8_t)y, (uint8_t)x, (uint8_t)length, (uint16_t)pixels};
+            memcpy(&sprite_pixels[pixels], &canvas->pixels[y * SPRITE_CANVAS_SIZE + x], length * sizeof(uint16_t));
+            pixels += length;
+            x += length;
+        }
+    }
+
+    sprite->run_count = runs - run_count;
+    run_count = runs;
+    pixel_count = pixels;
+    return sprite_count++;
+}
+
+const Sprite *get_sprite(int index) {
+    return &sprites[index];
+}
+
+void blit_sprite(const Sprite *sprite, int x, int y, int y_begin, int y_end) {
+    const SpriteRun *run = &sprite_runs[sprite->first_run];
+    const SpriteRun *last = run + sprite->run_count;
+
+    // wrap the canvas corner once, the runs are offsets from it
+    int left = (x + sprite->x0) % SCREEN_WIDTH;
+    if (left < 0) left += SCREEN_WIDTH;
+    int top = y + sprite->y0;
+
+    // runs are sorted by row, skip to the first row inside the band
+    while (run < last && top + run->y < y_begin) run++;
+
+    for (; run < last; run++) {
+        int screen_y = top + run->y;
+        if (screen_y >= y_end) break;
+
+        int screen_x = left + run->x;
+        while (screen_x >= SCREEN_WIDTH) screen_x -= SCREEN_WIDTH;
+
+        const uint16_t *pixels = &sprite_pixels[run->pixel];
+        uint16_t *row = bitmap_row(screen_y);
+
+        // a run crossing the right edge continues at the left edge of the same row
+        int right = SCREEN_WIDTH - screen_x;
+        if (run->length <= right) {
+            copy_pixels(&row[screen_x], pixels, run->length);
+        } else {
+            copy_pixels(&row[screen_x], pixels, right);
+            copy_pixels(row, &pixels[right], run->length - right);
+        }
+    }
+}
@@ -0,0 +1,215 @@
+/*
+  Delta frame encoder and the task that writes the packets.
+
+  loop() only compares and encodes, which is a single pass over the frame. The
+  bytes go out on a low priority task, a serial port slower than the frame
+  rate makes frames skip instead of stalling the render loop.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "stream.h"
+
+#include "pixels.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+
+// what the receiver shows, all zero until the first key frame
+static uint16_t reference[SCREEN_WIDTH * SCREEN_HEIGHT] __attribute__((aligned(4)));
+
+static uint8_t packet[STREAM_MAX_PACKET];
+static size_t packet_size;
+
+static StreamStats stats;
+
+static void put_u16(uint8_t *p, uint16_t value) {
+    p[0] = value;
+    p[1] = value >> 8;
+}
+
+static void put_u32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++) p[i] = value >> (8 * i);
+}
+
+uint32_t stream_checksum(const uint8_t *data, size_t size) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ data[i]) * FNV_PRIME;
+    return hash;
+}
+
+// skip and literal tokens for frame against reference, stops after the last changed pixel
+static uint8_t *encode_payload(const uint16_t *frame, uint16_t *reference, uint8_t *out) {
+    const int pixels = SCREEN_WIDTH * SCREEN_HEIGHT;
+    int i = 0;
+
+    for (;;) {
+        int unchanged = first_changed_pixel(&frame[i], &reference[i], pixels - i);
+        if (i + unchanged == pixels) return out;
+        i += unchanged;
+
+        for (; unchanged > 0; unchanged -= STREAM_MAX_RUN) {
+            *out++ = (unchanged < STREAM_MAX_RUN ? unchanged : STREAM_MAX_RUN) - 1;
+        }
+
+        int changed = 0;
+        while (i + changed < pixels && changed < STREAM_MAX_RUN && frame[i + changed] != reference[i + changed]) changed++;
+
+        *out++ = STREAM_LITERAL | (changed - 1);
+        copy_pixels(&reference[i], &frame[i], changed);
+        for (int end = i + changed; i < end; i++) {
+            put_u16(out, frame[i]);
+            out += 2;
+        }
+    }
+}
+
+size_t encode_stream_packet(const uint16_t *frame, uint16_t *reference, uint32_t sequence, bool key, uint8_t *packet) {
+    if (key) fill_pixels(reference, 0, SCREEN_WIDTH * SCREEN_HEIGHT);
+
+    uint8_t *end = encode_payload(frame, reference, packet + STREAM_HEADER_SIZE);
+    uint32_t payload = end - (packet + STREAM_HEADER_SIZE);
+
+    packet[0] = STREAM_SYNC_0;
+    packet[1] = STREAM_SYNC_1;
+    packet[2] = key ? STREAM_KEY : STREAM_DELTA;
+    packet[3] = 0;
+    put_u32(packet + 4, sequence);
+    put_u16(packet + 8, SCREEN_WIDTH);
+    put_u16(packet + 10, SCREEN_HEIGHT);
+    put_u32(packet + 12, payload);
+    put_u32(end, stream_checksum(packet, STREAM_HEADER_SIZE + payload));
+
+    return STREAM_HEADER_SIZE + payload + STREAM_CHECKSUM_SIZE;
+}
+
+bool apply_stream_payload(const uint8_t *payload, size_t size, uint16_t *frame, size_t pixels) {
+    const uint8_t *end = payload + size;
+    size_t i = 0;
+
+    while (payload < end) {
+        uint8_t token = *payload++;
+
+        if (token < STREAM_LITERAL) {
+            i += token + 1;
+            continue;
+        }
+
+        size_t count = token - STREAM_LITERAL + 1;
+        if (i + count > pixels || payload + count * 2 > end) return false;
+
+        for (size_t n = 0; n < count; n++, payload += 2) frame[i++] = payload[0] | payload[1] << 8;
+    }
+    return i <= pixels;
+}
+
+static void write_packet() {
+    Serial.write(packet, packet_size);
+}
+
+#if defined(ESP32)
+
+// idle is given while no packet is being written
+static SemaphoreHandle_t stream_idle;
+static SemaphoreHandle_t stream_start;
+
+static void stream_task(void *arg) {
+    for (;;) {
+        xSemaphoreTake(stream_start, portMAX_DELAY);
+        write_packet();
+        xSemaphoreGive(stream_idle);
+    }
+}
+
+void stream_begin() {
+    stream_idle = xSemaphoreCreateBinary();
+    stream_start = xSemaphoreCreateBinary();
+    xSemaphoreGive(stream_idle);
+
+    xTaskCreate(stream_task, "stream", STREAM_TASK_STACK_SIZE, NULL, STREAM_TASK_PRIORITY, NULL);
+}
+
+static bool try_take_idle() {
+    return xSemaphoreTake(stream_idle, 0) == pdTRUE;
+}
+
+static void kick_stream() {
+    xSemaphoreGive(stream_start);
+}
+
+void stream_wait() {
+    xSemaphoreTake(stream_idle, portMAX_DELAY);
+    xSemaphoreGive(stream_idle);
+}
+
+#else
+
+// never destroyed, the detached stream thread still waits on them when the program exits
+static std::mutex &stream_mutex = *new std::mutex;
+static std::condition_variable &stream_changed = *new std::condition_variable;
+static bool stream_busy = false;
+
+static void stream_task() {
+    std::unique_lock<std::mutex> lock(stream_mutex);
+    for (;;) {
+        stream_changed.wait(lock, [] { return stream_busy; });
+
+        lock.unlock();
+        write_packet();
+        lock.lock();
+
+        stream_busy = false;
+        stream_changed.notify_all();
+    }
+}
+
+void stream_begin() {
+    std::thread(stream_task).detach();
+}
+
+static bool try_take_idle() {
+    std::lock_guard<std::mutex> lock(stream_mutex);
+    return !stream_busy;
+}
+
+static void kick_stream() {
+    std::lock_guard<std::mutex> lock(stream_mutex);
+    stream_busy = true;
+    stream_changed.notify_all();
+}
+
+void stream_wait() {
+    std::unique_lock<std::mutex> lock(stream_mutex);
+    stream_changed.wait(lock, [] { return !stream_busy; });
+}
+
+#endif
+
+void stream_submit(const uint16_t *frame) {
+    if (!try_take_idle()) {
+        stats.frames_skipped++;
+        return;
+    }
+
+    bool key = stats.frames_sent % STREAM_KEYFRAME_INTERVAL == 0;
+    packet_size = encode_stream_packet(frame, reference, stats.frames_sent, key, packet);
+
+    stats.frames_sent++;
+    stats.bytes_sent += packet_size;
+    kick_stream();
+}
+
+StreamStats stream_stats() {
+    return stats;
+}
@@ -0,0 +1,88 @@
+/*
+  Strip renderer, see strips.h.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "strips.h"
+
+#include "pixels.h"
+#include "present.h"
+#include "profile.h"
+
+// the transfer task sends one strip while the next is built in the other
+static uint16_t strip_buffers[2][STRIP_ROWS * SCREEN_WIDTH] __attribute__((aligned(4)));
+static int next_buffer = 0;
+
+// hash of every strip on the panel, only valid when strip_known is set
+static uint32_t strip_hashes[STRIP_COUNT];
+static bool strip_known[STRIP_COUNT];
+
+static StripStats stats;
+
+// add the cycles since mark to stage and move mark to now
+static void add_cycles(uint32_t *cycles, ProfileStage stage, uint32_t *mark) {
+    uint32_t now = profile_cycles();
+    cycles[stage] += now - *mark;
+    *mark = now;
+}
+
+void reset_strips() {
+    for (int s = 0; s < STRIP_COUNT; s++) strip_known[s] = false;
+}
+
+int render_strips(double time) {
+    uint32_t cycles[PROFILE_STAGE_COUNT] = {};
+    uint32_t mark = profile_cycles();
+    uint16_t *frame = bitmap;
+    int sent = 0;
+
+    prepare_world(time);
+
+    for (int s = 0; s < STRIP_COUNT; s++) {
+        int y_begin = s * STRIP_ROWS;
+        int y_end = y_begin + STRIP_ROWS;
+
+        // a buffer that was submitted may still be on the bus, the other one is free
+        bitmap = strip_buffers[next_buffer];
+        bitmap_first_row = y_begin;
+
+        build_world_band(y_begin, y_end);
+        add_cycles(cycles, PROFILE_WORLD, &mark);
+
+        plant_trees_band(time, y_begin, y_end);
+        add_cycles(cycles, PROFILE_TREES, &mark);
+
+        uint32_t hash = hash_pixels(bitmap, STRIP_ROWS * SCREEN_WIDTH, PIXEL_HASH_BASIS);
+        bool changed = !strip_known[s] || strip_hashes[s] != hash;
+        strip_hashes[s] = hash;
+        strip_known[s] = true;
+        add_cycles(cycles, PROFILE_DIFF, &mark);
+
+        if (!changed) {
+            stats.strips_skipped++;
+            continue;
+        }
+
+        // waits for the strip before it, then this buffer is on the bus until the next submit
+        present_submit_rows(bitmap, y_begin, y_end);
+        next_buffer ^= 1;
+        stats.strips_sent++;
+        sent++;
+        add_cycles(cycles, PROFILE_PRESENT, &mark);
+    }
+
+    // the strips of a frame count as one sample per stage, like a full frame render
+    for (int stage = PROFILE_WORLD; stage <= PROFILE_PRESENT; stage++) profile_record((ProfileStage)stage, cycles[stage]);
+    profile_count(PROFILE_PIXELS_REWRITTEN, sent * STRIP_ROWS * SCREEN_WIDTH);
+    profile_count(PROFILE_SPI_BYTES, sent * (SSD1331_WINDOW_COMMAND_BYTES + STRIP_ROWS * SCREEN_WIDTH * sizeof(uint16_t)));
+
+    bitmap = frame;
+    bitmap_first_row = 0;
+    return sent;
+}
+
+StripStats strip_stats() {
+    return stats;
+}
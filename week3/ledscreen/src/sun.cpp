@@ -0,0 +1,63 @@
+/*
+  Sun glow map, built once and blended with integer math.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "sun.h"
+
+SunOverlay sun_overlay = {};
+
+// sun weight for a pixel, 1 - blend_curve of the original per pixel formula
+static uint8_t sun_alpha_at(int x, int y, float range) {
+    float sun_blend = (SCREEN_WIDTH - x) * (SCREEN_WIDTH - x) + y * y;
+    if (sun_blend >= range) return 0;
+
+    float invert = 1 - sun_blend / range;
+    float weight = invert * invert * invert * invert;
+    return (uint8_t)(weight * BLEND_ALPHA_MAX + 0.5f);
+}
+
+// the glow gets weaker further down a column, so every column is one run from the top
+static int sun_column_rows(int x, float range) {
+    int rows = 0;
+    while (rows < SCREEN_HEIGHT && sun_alpha_at(x, rows, range) > 0) rows++;
+    return rows;
+}
+
+int sun_glow_pixels(float range) {
+    int pixels = 0;
+    for (int x = 0; x < SCREEN_WIDTH; x++) pixels += sun_column_rows(x, range);
+    return pixels;
+}
+
+void build_sun_overlay() {
+    uint32_t size = 0;
+
+    for (int x = 0; x < SCREEN_WIDTH; x++) {
+        int rows = sun_column_rows(x, sun_range);
+        // load_scene() keeps the glow inside the map, cut it off rather than write past it
+        if (size + rows > SUN_GLOW_MAX_PIXELS) rows = SUN_GLOW_MAX_PIXELS - size;
+
+        sun_overlay.rows[x] = rows;
+        sun_overlay.offset[x] = size;
+        size += rows;
+    }
+
+    sun_overlay.size = size;
+
+    for (int x = 0; x < SCREEN_WIDTH; x++) {
+        uint8_t *alpha = &sun_overlay.alpha[sun_overlay.offset[x]];
+        for (int y = 0; y < sun_overlay.rows[x]; y++) alpha[y] = sun_alpha_at(x, y, sun_range);
+    }
+}
+
+void blend_sun_column(int x, int y_begin, int y_end, uint16_t *column) {
+    const uint8_t *alpha = &sun_overlay.alpha[sun_overlay.offset[x]];
+    if (y_end > sun_overlay.rows[x]) y_end = sun_overlay.rows[x];
+
+    for (int y = y_begin; y < y_end; y++) {
+        column[y] = blend_rgb565(palette.sun, column[y], alpha[y]);
+    }
+}
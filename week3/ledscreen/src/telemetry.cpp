@@ -0,0 +1,203 @@
+/*
+  Frame telemetry ring and drain task.
+
+  The ring has one producer, loop(), and one consumer, the drain task. Each side
+  only writes its own index, so a push or drain never waits on the other side.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "telemetry.h"
+
+#include "profile.h"
+
+#include <atomic>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <thread>
+#endif
+
+static_assert((TELEMETRY_RING_SIZE & (TELEMETRY_RING_SIZE - 1)) == 0, "TELEMETRY_RING_SIZE must be a power of two");
+
+static FrameTiming ring[TELEMETRY_RING_SIZE];
+
+// free running indices, head is written by the producer and tail by the consumer
+static std::atomic<uint32_t> head(0);
+static std::atomic<uint32_t> tail(0);
+static std::atomic<uint32_t> dropped(0);
+
+bool telemetry_push(const FrameTiming *timing) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == TELEMETRY_RING_SIZE) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    ring[h % TELEMETRY_RING_SIZE] = *timing;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+int telemetry_drain(FrameTiming *timings, int max) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t available = head.load(std::memory_order_acquire) - t;
+
+    int count = available < (uint32_t)max ? available : max;
+    for (int i = 0; i < count; i++) timings[i] = ring[(t + i) % TELEMETRY_RING_SIZE];
+
+    tail.store(t + count, std::memory_order_release);
+    return count;
+}
+
+uint32_t telemetry_dropped() {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+// sums of the frames drained since the last summary line
+typedef struct {
+    uint32_t frames;
+    uint64_t stage_us[FRAME_STAGE_COUNT];
+    uint64_t idle_us;
+    uint32_t max_frame_us;
+    uint32_t over_budget[FRAME_STAGE_COUNT];
+    uint32_t late;
+    uint8_t min_quality;
+    uint8_t max_quality;
+} Summary;
+
+static void add_timing(Summary *summary, const FrameTiming *timing) {
+    uint32_t frame_us = 0;
+    for (int s = 0; s < FRAME_STAGE_COUNT; s++) {
+        summary->stage_us[s] += timing->stage_us[s];
+        if (timing->over_budget & (1 << s)) summary->over_budget[s]++;
+        frame_us += timing->stage_us[s];
+    }
+
+    summary->idle_us += timing->idle_us;
+    if (frame_us > summary->max_frame_us) summary->max_frame_us = frame_us;
+    if (timing->late) summary->late++;
+    if (summary->frames == 0 || timing->quality < summary->min_quality) summary->min_quality = timing->quality;
+    if (summary->frames == 0 || timing->quality > summary->max_quality) summary->max_quality = timing->quality;
+    summary->frames++;
+}
+
+// one line per interval: average ms per stage, worst frame and what missed its budget
+static void print_summary(const Summary *summary, uint32_t dropped_frames) {
+    uint64_t total_us = summary->idle_us;
+    for (int s = 0; s < FRAME_STAGE_COUNT; s++) total_us += summary->stage_us[s];
+
+    Serial.print("fps: ");
+    Serial.print(summary->frames * 1000000.0 / total_us);
+
+    for (int s = 0; s < FRAME_STAGE_COUNT; s++) {
+        Serial.print(", ");
+        Serial.print(frame_stage_names[s]);
+        Serial.print(": ");
+        Serial.print(summary->stage_us[s] / 1000.0 / summary->frames);
+    }
+
+    Serial.print(", idle: ");
+    Serial.print(summary->idle_us / 1000.0 / summary->frames);
+    Serial.print(" millis, max frame: ");
+    Serial.print(summary->max_frame_us / 1000.0);
+    Serial.print(" millis, over budget:");
+
+    bool any = false;
+    for (int s = 0; s < FRAME_STAGE_COUNT; s++) {
+        if (summary->over_budget[s] == 0) continue;
+        Serial.print(" ");
+        Serial.print(frame_stage_names[s]);
+        Serial.print(" ");
+        Serial.print(summary->over_budget[s]);
+        any = true;
+    }
+    if (!any) Serial.print(" none");
+
+    Serial.print(", late: ");
+    Serial.print(summary->late);
+
+    // detail levels the frames of the interval were rendered at
+    Serial.print(", quality: ");
+    Serial.print((int)summary->min_quality);
+    if (summary->max_quality != summary->min_quality) {
+        Serial.print("-");
+        Serial.print((int)summary->max_quality);
+    }
+    Serial.print(", dropped: ");
+    Serial.println((unsigned long)dropped_frames);
+}
+
+// summaries and profile dumps, off while the port carries the frame stream
+static bool serial_output = true;
+
+static void drain_interval() {
+    static uint32_t dropped_before = 0;
+
+    Summary summary = {};
+    FrameTiming batch[TELEMETRY_BATCH_SIZE];
+
+    int count;
+    while ((count = telemetry_drain(batch, TELEMETRY_BATCH_SIZE)) > 0) {
+        for (int i = 0; i < count; i++) add_timing(&summary, &batch[i]);
+    }
+    if (summary.frames == 0 || !serial_output) return;
+
+    uint32_t dropped_now = telemetry_dropped();
+    print_summary(&summary, dropped_now - dropped_before);
+    dropped_before = dropped_now;
+}
+
+// the serial monitor asks for the profile with a single character
+static void answer_profile_requests() {
+    while (serial_output && Serial.available() > 0) {
+        int request = Serial.read();
+
+        if (request == TELEMETRY_PROFILE_CSV) {
+            static char csv[TELEMETRY_CSV_SIZE];
+            profile_write_csv(csv, sizeof(csv));
+            Serial.print(csv);
+        } else if (request == TELEMETRY_PROFILE_BINARY) {
+            ProfileSnapshot snapshot;
+            profile_snapshot(&snapshot);
+            Serial.write((const uint8_t *)&snapshot, sizeof(snapshot));
+        } else if (request == TELEMETRY_PROFILE_RESET) {
+            profile_reset();
+        }
+    }
+}
+
+#if defined(ESP32)
+
+static void telemetry_task(void *arg) {
+    for (;;) {
+        delay(TELEMETRY_INTERVAL_MS);
+        drain_interval();
+        answer_profile_requests();
+    }
+}
+
+void telemetry_begin(bool output) {
+    serial_output = output;
+    xTaskCreate(telemetry_task, "telemetry", TELEMETRY_TASK_STACK_SIZE, NULL, TELEMETRY_TASK_PRIORITY, NULL);
+}
+
+#else
+
+static void telemetry_task() {
+    for (;;) {
+        delay(TELEMETRY_INTERVAL_MS);
+        drain_interval();
+        answer_profile_requests();
+    }
+}
+
+void telemetry_begin(bool output) {
+    serial_output = output;
+    std::thread(telemetry_task).detach();
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+  Tree sprites and planting.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "trees.h"
+
+#include "palette.h"
+
+// sprite of every tree, -1 when it did not fit in the sprite pools
+static int8_t tree_sprite[MAX_TREES];
+
+// only the canvas is needed while building, keep it off the stack
+static SpriteCanvas canvas;
+
+// draw a triangle that looks like a leaf. from the tree object
+static void make_leaf(const Tree *tree, int space, uint16_t color) {
+    for (int y = 0; y < tree->height; y++) {
+        for (int x = tree->width - y + tree->width / 2; x <= tree->width + y - tree->width / 2; x++) {
+            sprite_canvas_pixel(&canvas, x, y + space, color);
+        }
+    }
+}
+
+// draw the tree relative to its pos_x, pos_y, leaf holds the baked shades of the three leaf layers
+static void draw_tree(const Tree *tree, const uint16_t *leaf) {
+    int space = tree->height / 2;
+
+    // the lower leaf rows can reach left of the tree position
+    int left = tree->width + tree->width / 2 - tree->height + 1;
+    clear_sprite_canvas(&canvas, left < 0 ? left : 0, -space);
+
+    for (int y = 0; y < tree->root_height; y++) {
+        for (int x = 0; x < tree->root_width; x++) {
+            sprite_canvas_pixel(&canvas, x + (tree->width + tree->root_width) / 2, y + tree->height + space, palette.tree_bark);
+        }
+    }
+
+    make_leaf(tree, -space, leaf[0]);
+    make_leaf(tree, 0, leaf[1]);
+    make_leaf(tree, space, leaf[2]);
+}
+
+static bool same_tree_sprite(int a, int b) {
+    const Tree *ta = &trees[a];
+    const Tree *tb = &trees[b];
+
+    return ta->height == tb->height && ta->width == tb->width &&
+           ta->root_height == tb->root_height && ta->root_width == tb->root_width &&
+           memcmp(palette.leaf[a], palette.leaf[b], sizeof(palette.leaf[a])) == 0;
+}
+
+void build_tree_sprites() {
+    reset_sprites();
+
+    for (int i = 0; i < amount_of_trees; i++) {
+        tree_sprite[i] = -1;
+
+        for (int j = 0; j < i; j++) {
+            if (tree_sprite[j] >= 0 && same_tree_sprite(i, j)) {
+                tree_sprite[i] = tree_sprite[j];
+                break;
+            }
+        }
+        if (tree_sprite[i] >= 0) continue;
+
+        draw_tree(&trees[i], palette.leaf[i]);
+        tree_sprite[i] = build_sprite(&canvas);
+        if (tree_sprite[i] < 0) Serial.println("Tree does not fit in the sprite pools, skipped");
+    }
+}
+
+// trees only touch the rows [y_begin, y_end) so bands can be planted in parallel
+void plant_trees_band(double time, int y_begin, int y_end) {
+    for (int i = 0; i < amount_of_trees; i++) {
+        if (tree_sprite[i] < 0) continue;
+
+        const Tree *tree = &trees[i];
+        int pos_x = tree->pos_x - (time * tree->speed);
+        blit_sprite(get_sprite(tree_sprite[i]), pos_x, tree->pos_y, y_begin, y_end);
+    }
+}
+
+void plant_trees(double time) {
+    plant_trees_band(time, 0, SCREEN_HEIGHT);
+}
@@ -0,0 +1,153 @@
+/*
+  Span based rasterizer for the background layers.
+
+  Every layer covers one vertical run per column: from just below its sine
+  surface down to the bottom of its band. Instead of testing every layer for
+  every pixel, the runs come from the scrolling layer strips and are filled
+  front to back into the rows that are still uncovered, so a column stops as
+  soon as the front layers cover it. Whatever stays uncovered is sky.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include "ledscreen.h"
+#include "palette.h"
+#include "pixels.h"
+#include "quality.h"
+#include "scroll.h"
+#include "sun.h"
+
+// uncovered runs in a column are separated by at least one covered row
+#define MAX_COLUMN_GAPS (SCREEN_HEIGHT / 2 + 1)
+
+// rows [y_begin, y_end) of one column
+typedef struct {
+    int y_begin;
+    int y_end;
+} Span;
+
+// values of a layer that only change once per frame
+typedef struct {
+    const LayerStrip *strip;
+    int band_begin;
+    int band_end;
+    int base_begin;
+    uint16_t shade;
+    uint16_t plain;
+} LayerFrame;
+
+// prepared once per frame by prepare_world(), read by every band
+static LayerFrame layer_frames[MAX_LAYERS];
+
+static int clamp_row(int y) {
+    if (y < 0) return 0;
+    if (y > SCREEN_HEIGHT) return SCREEN_HEIGHT;
+    return y;
+}
+
+// a layer may only paint between its own top and the bottom of the next layer,
+// the last layer also fills everything below its wave with its plain color
+static void prepare_layer(LayerFrame *frame, int i, double time, double far_layer_time) {
+    const Background *layer = &layers[i];
+    const Background *next = i < amount_of_layer - 1 ? &layers[i + 1] : layer;
+
+    advance_layer_strip(i, (int)((is_far_layer(layer) ? far_layer_time : time) * layer->speed));
+
+    frame->strip = &layer_strips[i];
+    frame->band_begin = clamp_row(layer->pos_y - layer->amplitude);
+    frame->band_end = clamp_row(next->pos_y + next->amplitude + 1);
+    frame->base_begin = next == layer ? clamp_row(layer->pos_y + layer->amplitude + 1) : SCREEN_HEIGHT;
+    frame->shade = palette.layer_shade[i];
+    frame->plain = palette.layer_plain[i];
+}
+
+// paint the part of span that is still uncovered and remove it from the gaps
+static int fill_gaps(Span *gaps, int gap_count, Span span, uint16_t color, uint16_t *column) {
+    if (span.y_begin >= span.y_end) return gap_count;
+
+    Span remaining[MAX_COLUMN_GAPS];
+    int remaining_count = 0;
+
+    for (int g = 0; g < gap_count; g++) {
+        Span gap = gaps[g];
+        int begin = gap.y_begin > span.y_begin ? gap.y_begin : span.y_begin;
+        int end = gap.y_end < span.y_end ? gap.y_end : span.y_end;
+
+        if (begin >= end) {
+            remaining[remaining_count++] = gap;
+            continue;
+        }
+
+        fill_pixels(&column[begin], color, end - begin);
+
+        if (gap.y_begin < begin) remaining[remaining_count++] = (Span){gap.y_begin, begin};
+        if (end < gap.y_end) remaining[remaining_count++] = (Span){end, gap.y_end};
+    }
+
+    memcpy(gaps, remaining, remaining_count * sizeof(Span));
+    return remaining_count;
+}
+
+// only the rows [y_begin, y_end) of the column are filled, band_layers are the layers
+// that can paint inside those rows, front to back
+static void build_column(int x, int y_begin, int y_end, const int *band_layers, int band_layer_count, uint16_t *column) {
+    Span gaps[MAX_COLUMN_GAPS] = {{y_begin, y_end}};
+    int gap_count = 1;
+
+    for (int l = 0; l < band_layer_count && gap_count > 0; l++) {
+        const LayerFrame *frame = &layer_frames[band_layers[l]];
+        int wave_begin = strip_wave_begin(frame->strip, x);
+
+        Span wave = {wave_begin > frame->band_begin ? wave_begin : frame->band_begin, frame->band_end};
+        gap_count = fill_gaps(gaps, gap_count, wave, frame->shade, column);
+        gap_count = fill_gaps(gaps, gap_count, (Span){frame->base_begin, SCREEN_HEIGHT}, frame->plain, column);
+    }
+
+    for (int g = 0; g < gap_count; g++) {
+        fill_pixels(&column[gaps[g].y_begin], palette.sky, gaps[g].y_end - gaps[g].y_begin);
+    }
+}
+
+void prepare_world(double time) {
+    double far_layer_time = quality_far_layer_time(time);
+    for (int i = 0; i < amount_of_layer; i++) prepare_layer(&layer_frames[i], i, time, far_layer_time);
+}
+
+// builds the rows [y_begin, y_end) of every column from the layer spans and blends the sun over the result,
+// at low quality without the sun and with every built column copied into the one next to it
+void build_world_band(int y_begin, int y_end) {
+    uint16_t column[SCREEN_HEIGHT];
+
+    // a thin band such as a strip only meets a few layers, the others are skipped for every column
+    int band_layers[MAX_LAYERS];
+    int band_layer_count = 0;
+    for (int i = amount_of_layer - 1; i >= 0; i--) {
+        const LayerFrame *frame = &layer_frames[i];
+        bool wave = frame->band_begin < y_end && frame->band_end > y_begin;
+        bool base = frame->base_begin < y_end;
+        if (wave || base) band_layers[band_layer_count++] = i;
+    }
+
+    QualityLevel level = quality_level();
+    bool sun_glow = level < QUALITY_NO_SUN;
+    int step = level >= QUALITY_HALF_WIDTH ? 2 : 1;
+
+    for (int x = 0; x < SCREEN_WIDTH; x += step) {
+        build_column(x, y_begin, y_end, band_layers, band_layer_count, column);
+
+        if (sun_glow) blend_sun_column(x, y_begin, y_end, column);
+
+        // the last column of an odd width has no neighbor to copy into
+        int width = x + step <= SCREEN_WIDTH ? step : SCREEN_WIDTH - x;
+        for (int y = y_begin; y < y_end; y++) {
+            uint16_t *pixel = &bitmap_row(y)[x];
+            for (int i = 0; i < width; i++) pixel[i] = column[y];
+        }
+    }
+}
+
+void build_world_layers(double time) {
+    prepare_world(time);
+    build_world_band(0, SCREEN_HEIGHT);
+}
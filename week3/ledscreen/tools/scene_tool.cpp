@@ -0,0 +1,258 @@
+/*
+  Converts text scenes to the binary scene format of scene.h and back.
+
+  g++ -std=gnu++17 -I host -I include tools/scene_tool.cpp src/scene.cpp -o scene_tool
+  ./scene_tool compile scenes/valley.txt scene.bin
+  ./scene_tool dump scene.bin
+
+  Text scenes have one item per line, # starts a comment:
+    sky 138 245 255
+    sun 255 255 0
+    tree_bark 148 108 22
+    tree_leaf 1 97 15
+    sun_range 5000
+    layer color=97,97,96 amplitude=7 waves=17 pos_y=10 speed=0 shade=0.6
+    tree pos_x=10 pos_y=25 leaf=1,0.6,1 height=10 width=5 root=7,3 speed=6
+  Layers are drawn back to front in the order they are listed. The four colors
+  are required, a value that does not fit its field or the renderer is an error.
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include <errno.h>
+#include <float.h>
+#include <stdio.h>
+
+#include "scene.h"
+#include "sine.h"
+
+#define LINE_SIZE 512
+
+static Scene scene;
+static uint8_t file[SCENE_MAX_SIZE];
+
+// next number of a list separated by spaces or commas, false when text does not start with
+// a number in [low, high] (NaN is never in range)
+static bool next_int(const char **text, long low, long high, int *value) {
+    char *end;
+    errno = 0;
+    long number = strtol(*text, &end, 10);
+    if (end == *text || errno != 0 || number < low || number > high) return false;
+    *value = number;
+    *text = end + strspn(end, " \t,");
+    return true;
+}
+
+static bool next_float(const char **text, float low, float high, float *value) {
+    char *end;
+    errno = 0;
+    float number = strtof(*text, &end);
+    if (end == *text || errno != 0 || !(number >= low && number <= high)) return false;
+    *value = number;
+    *text = end + strspn(end, " \t,");
+    return true;
+}
+
+// a value that is exactly one number in [low, high]
+static bool parse_int(const char *text, long low, long high, int *value) {
+    return next_int(&text, low, high, value) && *text == '\0';
+}
+
+static bool parse_float(const char *text, float low, float high, float *value) {
+    return next_float(&text, low, high, value) && *text == '\0';
+}
+
+static bool parse_color(const char *text, Color *c) {
+    int r, g, b;
+    if (!next_int(&text, 0, 255, &r) || !next_int(&text, 0, 255, &g) || !next_int(&text, 0, 255, &b) || *text != '\0') return false;
+    *c = (Color){(uint8_t)r, (uint8_t)g, (uint8_t)b};
+    return true;
+}
+
+// key=value pairs of a layer or tree line, false on a key that is unknown or a value that is
+// malformed or does not fit its field in the scene file
+static bool parse_layer(char *fields, Background *layer) {
+    *layer = (Background){};
+    layer->darken_color = 1;
+
+    for (char *field = strtok(fields, " \t"); field != NULL; field = strtok(NULL, " \t")) {
+        char *value = strchr(field, '=');
+        if (value == NULL) return false;
+        *value++ = '\0';
+
+        bool ok;
+        if (!strcmp(field, "color")) {
+            ok = parse_color(value, &layer->color);
+        } else if (!strcmp(field, "amplitude")) {
+            ok = parse_int(value, INT8_MIN, INT8_MAX, &layer->amplitude);
+        } else if (!strcmp(field, "waves")) {
+            float waves;
+            ok = parse_float(value, 0, SCENE_MAX_WAVES, &waves);
+            layer->frequency = sine_phase_step(waves, FULL_CIRCLE);
+        } else if (!strcmp(field, "pos_y")) {
+            ok = parse_int(value, INT16_MIN, INT16_MAX, &layer->pos_y);
+        } else if (!strcmp(field, "speed")) {
+            ok = parse_float(value, -SCENE_MAX_SPEED, SCENE_MAX_SPEED, &layer->speed);
+        } else if (!strcmp(field, "shade")) {
+            ok = parse_float(value, 0, 1, &layer->darken_color);
+        } else {
+            ok = false;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+static bool parse_tree(char *fields, Tree *tree) {
+    *tree = (Tree){};
+    tree->leaf1_shade = tree->leaf2_shade = tree->leaf3_shade = 1;
+
+    for (char *field = strtok(fields, " \t"); field != NULL; field = strtok(NULL, " \t")) {
+        char *value = strchr(field, '=');
+        if (value == NULL) return false;
+        *value++ = '\0';
+
+        const char *list = value;
+        bool ok;
+        if (!strcmp(field, "pos_x")) {
+            ok = parse_int(value, INT16_MIN, INT16_MAX, &tree->pos_x);
+        } else if (!strcmp(field, "pos_y")) {
+            ok = parse_int(value, INT16_MIN, INT16_MAX, &tree->pos_y);
+        } else if (!strcmp(field, "leaf")) {
+            ok = next_float(&list, 0, 1, &tree->leaf1_shade) && next_float(&list, 0, 1, &tree->leaf2_shade) &&
+                 next_float(&list, 0, 1, &tree->leaf3_shade) && *list == '\0';
+        } else if (!strcmp(field, "height")) {
+            ok = parse_int(value, 0, UINT8_MAX, &tree->height);
+        } else if (!strcmp(field, "width")) {
+            ok = parse_int(value, 0, UINT8_MAX, &tree->width);
+        } else if (!strcmp(field, "root")) {
+            ok = next_int(&list, 0, UINT8_MAX, &tree->root_height) && next_int(&list, 0, UINT8_MAX, &tree->root_width) && *list == '\0';
+        } else if (!strcmp(field, "speed")) {
+            ok = parse_int(value, INT16_MIN, INT16_MAX, &tree->speed);
+        } else {
+            ok = false;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+// the colors every scene must set, a missing one would silently draw black
+static const char *const required_keys[] = {"sky", "sun", "tree_bark", "tree_leaf"};
+#define REQUIRED_KEYS (sizeof(required_keys) / sizeof(required_keys[0]))
+static bool key_seen[REQUIRED_KEYS];
+
+static bool parse_line(char *line) {
+    char *comment = strchr(line, '#');
+    if (comment != NULL) *comment = '\0';
+
+    char *key = strtok(line, " \t\r\n");
+    if (key == NULL) return true;
+    char *rest = strtok(NULL, "\r\n");
+    if (rest == NULL) rest = (char *)"";
+
+    for (size_t i = 0; i < REQUIRED_KEYS; i++) {
+        if (!strcmp(key, required_keys[i])) key_seen[i] = true;
+    }
+
+    if (!strcmp(key, "sky")) return parse_color(rest, &scene.sky);
+    if (!strcmp(key, "sun")) return parse_color(rest, &scene.sun);
+    if (!strcmp(key, "tree_bark")) return parse_color(rest, &scene.tree_bark);
+    if (!strcmp(key, "tree_leaf")) return parse_color(rest, &scene.tree_leaf);
+    if (!strcmp(key, "sun_range")) return parse_float(rest, 0, FLT_MAX, &scene.sun_range);
+
+    if (!strcmp(key, "layer")) {
+        if (scene.layer_count == MAX_LAYERS) return false;
+        return parse_layer(rest, &scene.layers[scene.layer_count++]);
+    }
+    if (!strcmp(key, "tree")) {
+        if (scene.tree_count == MAX_TREES) return false;
+        return parse_tree(rest, &scene.trees[scene.tree_count++]);
+    }
+    return false;
+}
+
+static int compile(const char *text_path, const char *scene_path) {
+    FILE *in = fopen(text_path, "r");
+    if (in == NULL) {
+        perror(text_path);
+        return 1;
+    }
+
+    char line[LINE_SIZE];
+    for (int number = 1; fgets(line, sizeof(line), in) != NULL; number++) {
+        if (!parse_line(line)) {
+            fprintf(stderr, "%s:%d: cannot parse line, a value out of range, or more than %d layers / %d trees\n", text_path, number,
+                    MAX_LAYERS, MAX_TREES);
+            fclose(in);
+            return 1;
+        }
+    }
+    fclose(in);
+
+    for (size_t i = 0; i < REQUIRED_KEYS; i++) {
+        if (!key_seen[i]) {
+            fprintf(stderr, "%s: no %s line\n", text_path, required_keys[i]);
+            return 1;
+        }
+    }
+
+    // the firmware gets the file only when it decodes, trees too large for a sprite fail here
+    static Scene check;
+    size_t size = encode_scene(&scene, file, sizeof(file));
+    SceneResult result = size == 0 ? SCENE_TOO_MANY : decode_scene(file, size, &check);
+    if (result != SCENE_OK) {
+        fprintf(stderr, "%s: %s\n", text_path, scene_result_name(result));
+        return 1;
+    }
+
+    FILE *out = fopen(scene_path, "wb");
+    if (out == NULL || fwrite(file, 1, size, out) != size || fclose(out) != 0) {
+        perror(scene_path);
+        return 1;
+    }
+
+    printf("%s: %d layers, %d trees, %zu bytes\n", scene_path, scene.layer_count, scene.tree_count, size);
+    return 0;
+}
+
+static void print_color(const char *key, Color c) {
+    printf("%s %u %u %u\n", key, c.r, c.g, c.b);
+}
+
+// prints the scene back as text, compiling the output gives the same file
+static int dump(const char *scene_path) {
+    SceneResult result = read_scene(scene_path, &scene);
+    if (result != SCENE_OK) {
+        fprintf(stderr, "%s: %s\n", scene_path, scene_result_name(result));
+        return 1;
+    }
+
+    print_color("sky", scene.sky);
+    print_color("sun", scene.sun);
+    print_color("tree_bark", scene.tree_bark);
+    print_color("tree_leaf", scene.tree_leaf);
+    printf("sun_range %g\n", scene.sun_range);
+
+    for (int i = 0; i < scene.layer_count; i++) {
+        const Background *l = &scene.layers[i];
+        printf("layer color=%u,%u,%u amplitude=%d waves=%g pos_y=%d speed=%g shade=%g\n", l->color.r, l->color.g, l->color.b,
+               l->amplitude, (double)l->frequency * FULL_CIRCLE / 4294967296.0, l->pos_y, l->speed, l->darken_color);
+    }
+
+    for (int i = 0; i < scene.tree_count; i++) {
+        const Tree *t = &scene.trees[i];
+        printf("tree pos_x=%d pos_y=%d leaf=%g,%g,%g height=%d width=%d root=%d,%d speed=%d\n", t->pos_x, t->pos_y, t->leaf1_shade,
+               t->leaf2_shade, t->leaf3_shade, t->height, t->width, t->root_height, t->root_width, t->speed);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 4 && !strcmp(argv[1], "compile")) return compile(argv[2], argv[3]);
+    if (argc == 3 && !strcmp(argv[1], "dump")) return dump(argv[2]);
+
+    fprintf(stderr, "usage: %s compile scene.txt scene.bin\n       %s dump scene.bin\n", argv[0], argv[0]);
+    return 1;
+}
@@ -0,0 +1,276 @@
+/*
+  Host receiver of the serial frame stream, see include/stream.h.
+  Rebuilds every frame from its delta and prints the bandwidth and compression
+  once a second and at the end of the stream.
+
+  g++ -std=gnu++17 -I host -I include tools/stream_viewer.cpp src/stream.cpp host/host.cpp -o stream_viewer -pthread
+  ./stream_viewer /dev/ttyUSB0                 the ESP32 with SERIAL_STREAM true
+  ./stream_viewer -d frames/ capture.bin       a stream written to a file by the bench
+  ./stream_viewer --pty                        open a pty and print its name, then run
+                                               .pio/build/native/program -T <name>
+
+  MIT License
+  Copyright (c) 2024 Jesse van Vuuren
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "stream.h"
+
+#define READ_SIZE 4096
+#define REPORT_INTERVAL_NS 1000000000LL
+
+// bytes read but not yet parsed, room for one whole packet plus a read
+static uint8_t input[STREAM_MAX_PACKET + READ_SIZE];
+static size_t input_length = 0;
+
+static uint16_t frame[SCREEN_WIDTH * SCREEN_HEIGHT];
+static bool have_frame = false;
+static uint32_t last_sequence = 0;
+
+typedef struct {
+    uint64_t frames;
+    uint64_t key_frames;
+    uint64_t bytes;
+    uint64_t packet_bytes;
+    uint64_t pixels;
+    uint64_t checksum_errors;
+    uint64_t lost;
+} Counters;
+
+static Counters total;
+static Counters interval;
+
+static const char *dump_dir = NULL;
+
+static int64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return p[0] | p[1] << 8;
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void dump_ppm(uint64_t index, int width, int height) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/stream_%06llu.ppm", dump_dir, (unsigned long long)index);
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) return;
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    for (int i = 0; i < width * height; i++) {
+        uint8_t r = (frame[i] >> 11) & 0x1F;
+        uint8_t g = (frame[i] >> 5) & 0x3F;
+        uint8_t b = frame[i] & 0x1F;
+        uint8_t rgb[3] = {(uint8_t)(r << 3 | r >> 2), (uint8_t)(g << 2 | g >> 4), (uint8_t)(b << 3 | b >> 2)};
+        fwrite(rgb, 1, sizeof(rgb), file);
+    }
+    fclose(file);
+}
+
+static void count(Counters *c, const Counters *add) {
+    c->frames += add->frames;
+    c->key_frames += add->key_frames;
+    c->bytes += add->bytes;
+    c->packet_bytes += add->packet_bytes;
+    c->pixels += add->pixels;
+    c->checksum_errors += add->checksum_errors;
+    c->lost += add->lost;
+}
+
+static void report(const char *label, const Counters *c, double seconds) {
+    double ratio = c->packet_bytes > 0 ? (double)c->pixels * 2 / c->packet_bytes : 0;
+    double bytes_per_frame = c->frames > 0 ? (double)c->packet_bytes / c->frames : 0;
+
+    printf("%s: %llu frames (%llu key), %.1f fps, %.1f kbit/s, %.0f bytes/frame, compression %.1fx, "
+           "checksum errors %llu, lost %llu\n",
+           label, (unsigned long long)c->frames, (unsigned long long)c->key_frames, c->frames / seconds,
+           c->bytes * 8 / seconds / 1000, bytes_per_frame, ratio, (unsigned long long)c->checksum_errors,
+           (unsigned long long)c->lost);
+    fflush(stdout);
+}
+
+// one packet at the start of input, returns the bytes used or 0 when more input is needed
+static size_t parse_packet(Counters *c) {
+    if (input_length < STREAM_HEADER_SIZE) return 0;
+
+    int width = get_u16(input + 8);
+    int height = get_u16(input + 10);
+    size_t payload = get_u32(input + 12);
+
+    // not a header after all, move one byte on and look for the next sync
+    if (width * height > SCREEN_WIDTH * SCREEN_HEIGHT || payload > STREAM_MAX_PAYLOAD) return 1;
+
+    size_t size = STREAM_HEADER_SIZE + payload + STREAM_CHECKSUM_SIZE;
+    if (input_length < size) return 0;
+
+    if (stream_checksum(input, size - STREAM_CHECKSUM_SIZE) != get_u32(input + size - STREAM_CHECKSUM_SIZE)) {
+        c->checksum_errors++;
+        return 1;
+    }
+
+    bool key = input[2] == STREAM_KEY;
+    uint32_t sequence = get_u32(input + 4);
+
+    // a delta only applies on top of the frame before it
+    if (!key && (!have_frame || sequence != last_sequence + 1)) {
+        c->lost++;
+        have_frame = false;
+        return size;
+    }
+
+    if (key) memset(frame, 0, sizeof(frame));
+    if (!apply_stream_payload(input + STREAM_HEADER_SIZE, payload, frame, width * height)) {
+        c->checksum_errors++;
+        have_frame = false;
+        return size;
+    }
+
+    have_frame = true;
+    last_sequence = sequence;
+    c->frames++;
+    c->key_frames += key;
+    c->packet_bytes += size;
+    c->pixels += width * height;
+
+    if (dump_dir != NULL) dump_ppm(total.frames + c->frames - 1, width, height);
+    return size;
+}
+
+static void parse_input(Counters *c) {
+    size_t start = 0;
+
+    for (;;) {
+        while (start + 1 < input_length && !(input[start] == STREAM_SYNC_0 && input[start + 1] == STREAM_SYNC_1)) start++;
+        if (start + 1 >= input_length) break;
+
+        memmove(input, input + start, input_length - start);
+        input_length -= start;
+        start = 0;
+
+        size_t used = parse_packet(c);
+        if (used == 0) return;
+        start = used;
+    }
+
+    // keep a trailing half sync byte for the next read
+    size_t keep = input_length > 0 && start < input_length && input[input_length - 1] == STREAM_SYNC_0 ? 1 : 0;
+    memmove(input, input + input_length - keep, keep);
+    input_length = keep;
+}
+
+static int open_pty() {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return -1;
+
+    struct termios settings;
+    if (tcgetattr(master, &settings) == 0) {
+        cfmakeraw(&settings);
+        tcsetattr(master, TCSANOW, &settings);
+    }
+
+    printf("%s\n", ptsname(master));
+    fflush(stdout);
+    return master;
+}
+
+static int open_input(const char *path) {
+    int port = open(path, O_RDONLY | O_NOCTTY);
+    if (port < 0) return -1;
+
+    // a serial port runs at the stream baud rate of the firmware
+    struct termios settings;
+    if (tcgetattr(port, &settings) == 0) {
+        cfmakeraw(&settings);
+        cfsetspeed(&settings, B921600);
+        tcsetattr(port, TCSANOW, &settings);
+    }
+    return port;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [-d ppm dump dir] serial port | stream file | --pty\n", name);
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    bool pty = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+            dump_dir = argv[++i];
+        } else if (!strcmp(argv[i], "--pty")) {
+            pty = true;
+        } else if (path == NULL && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (pty == (path != NULL)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (dump_dir != NULL && mkdir(dump_dir, 0755) != 0 && errno != EEXIST) {
+        perror(dump_dir);
+        return 1;
+    }
+
+    int port = pty ? open_pty() : open_input(path);
+    if (port < 0) {
+        perror(pty ? "pty" : path);
+        return 1;
+    }
+
+    int64_t start = now_ns();
+    int64_t interval_start = start;
+    bool connected = false;
+
+    for (;;) {
+        ssize_t n = read(port, input + input_length, READ_SIZE);
+
+        // a pty reads EIO until the writer opens it and again once it closes
+        if (n < 0 && errno == EIO && pty && !connected) {
+            usleep(10000);
+            continue;
+        }
+        if (n <= 0) break;
+
+        if (!connected) {
+            connected = true;
+            start = interval_start = now_ns();
+        }
+
+        input_length += n;
+        interval.bytes += n;
+        parse_input(&interval);
+
+        int64_t now = now_ns();
+        if (now - interval_start >= REPORT_INTERVAL_NS) {
+            report("last second", &interval, (now - interval_start) / 1e9);
+            count(&total, &interval);
+            interval = (Counters){};
+            interval_start = now;
+        }
+    }
+
+    count(&total, &interval);
+    report("total", &total, (now_ns() - start) / 1e9);
+    return 0;
+}
@@ -0,0 +1,247 @@
+/*
+
+  Host benchmark of the SPI traffic of the sensor display.
+
+  Feeds decoded signals to loop() and counts the SPI transactions and bytes of
+  every screen update. The same screens are also drawn the way the display did
+  before the frame buffer, straight through Adafruit_GFX: clear the screen, draw
+  the layout and print every field, and the unknown signal icon with
+  drawRGBBitmap() and fillRect(). Both panels must end up showing the same pixels.
+
+  pio run -e native -t exec
+  .pio/build/native/program -n 1000 -s 7
+  .pio/build/native/program -r 100000      replay signal streams through the IR analytics, see replay.cpp
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#include <Adafruit_SSD1331.h>
+#include <IRremoteInt.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "frameBuffer.h"
+#include "icons.h"
+#include "irEvents.h"
+#include "widgets.h"
+
+#define DEFAULT_SIGNALS 1000
+#define DEFAULT_SEED 1
+
+// Colors and icon position of main.cpp
+#define BACKGROUND_COLOR 0x0000
+#define TEXT_COLOR 0xFFFF
+#define LINE_COLOR 0x7BEF
+
+#define ICON_POSITION_X 74
+#define ICON_POSITION_Y 44
+#define BLINK_COUNT 3
+
+// Long enough for the whole blink of the unknown signal icon
+#define BLINK_WAIT_MS 700
+
+// Remotes the benchmark pretends to point at the sensor, each with its own address
+#define REMOTES 3
+
+typedef struct {
+  uint32_t updates;
+  uint64_t transactions;
+  uint64_t bytes;
+  uint32_t maxTransactions;
+  uint32_t maxBytes;
+} Traffic;
+
+void setup();
+void loop();
+extern Adafruit_SSD1331 display;
+
+int runReplay(int events, uint32_t seed);
+
+// Panel drawn the old way, next to the one main.cpp draws
+static Adafruit_SSD1331 directDisplay(0, 0, 0, 0, 0);
+
+static uint32_t randomState;
+
+static uint32_t nextRandom() {
+  randomState = randomState * 1664525 + 1013904223;
+  return randomState >> 8;
+}
+
+static uint64_t nowNanos() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void addTraffic(Traffic* traffic, Adafruit_SSD1331* panel, uint32_t transactions, uint32_t bytes) {
+  transactions = panel->transactions - transactions;
+  bytes = panel->bytesSent - bytes;
+
+  traffic->updates++;
+  traffic->transactions += transactions;
+  traffic->bytes += bytes;
+  traffic->maxTransactions = max(traffic->maxTransactions, transactions);
+  traffic->maxBytes = max(traffic->maxBytes, bytes);
+}
+
+static void printTraffic(const char* name, const Traffic* traffic) {
+  printf("%-22s %8.1f %8u %10.1f %8u\n", name, (double)traffic->transactions / traffic->updates, traffic->maxTransactions,
+         (double)traffic->bytes / traffic->updates, traffic->maxBytes);
+}
+
+// The screen the way loop() drew it before the frame buffer
+static void drawDirect() {
+  int count, lineCount;
+  const DataDisplayObject* objects = getWidgets(&count);
+  const Line* lines = getWidgetLines(&lineCount);
+
+  directDisplay.fillScreen(BACKGROUND_COLOR);
+
+  for (int i = 0; i < lineCount; i++) {
+    if (lines[i].direction == Horizontal) {
+      directDisplay.drawLine(lines[i].x, lines[i].y, lines[i].x + lines[i].length, lines[i].y, LINE_COLOR);
+    } else {
+      directDisplay.drawLine(lines[i].x, lines[i].y, lines[i].x, lines[i].y + lines[i].length, LINE_COLOR);
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    directDisplay.setCursor(objects[i].x, objects[i].y);
+    directDisplay.print(objects[i].label);
+    directDisplay.print(objects[i].shown);
+  }
+}
+
+static int differentPixels() {
+  int different = 0;
+  for (int i = 0; i < SSD1331_WIDTH * SSD1331_HEIGHT; i++) {
+    different += display.gddram[i] != directDisplay.gddram[i];
+  }
+  return different;
+}
+
+static void usage(const char* name) {
+  fprintf(stderr, "usage: %s [-n signals] [-s seed] [-r replay signals]\n", name);
+}
+
+int main(int argc, char** argv) {
+  int signals = DEFAULT_SIGNALS;
+  int replaySignals = 0;
+  randomState = DEFAULT_SEED;
+
+  int option;
+  while ((option = getopt(argc, argv, "n:s:r:h")) != -1) {
+    switch (option) {
+      case 'n':
+        signals = atoi(optarg);
+        break;
+      case 's':
+        randomState = strtoul(optarg, NULL, 0);
+        break;
+      case 'r':
+        replaySignals = atoi(optarg);
+        break;
+      default:
+        usage(argv[0]);
+        return option == 'h' ? 0 : 1;
+    }
+  }
+
+  if (signals < 2) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  setup();
+
+  if (replaySignals > 0) {
+    return runReplay(replaySignals, randomState);
+  }
+
+  directDisplay.begin();
+  directDisplay.setTextColor(TEXT_COLOR);
+
+  // The frame buffer clips text at the right edge, print() would wrap a counter of 1000 and up
+  directDisplay.setTextWrap(false);
+
+  Traffic direct = {};
+  Traffic buffered = {};
+  uint64_t composeNanos = 0;
+  int mismatches = 0;
+
+  for (int i = 0; i < signals; i++) {
+    IrEvent event = {
+      .protocol = NEC,
+      .flags = 0,
+      .address = (uint16_t)(nextRandom() % REMOTES),
+      .command = (uint16_t)(nextRandom() % 256),
+      .timeMs = (uint32_t)millis()
+    };
+    pushIrEvent(&event);
+
+    uint32_t transactions = display.transactions;
+    uint32_t bytes = display.bytesSent;
+    uint64_t start = nowNanos();
+
+    loop();
+
+    composeNanos += nowNanos() - start;
+
+    // The first signal replaces the waiting message with the whole layout in both versions
+    if (i > 0) {
+      addTraffic(&buffered, &display, transactions, bytes);
+    }
+
+    transactions = directDisplay.transactions;
+    bytes = directDisplay.bytesSent;
+
+    drawDirect();
+
+    if (i > 0) {
+      addTraffic(&direct, &directDisplay, transactions, bytes);
+    }
+
+    mismatches += differentPixels() != 0;
+  }
+
+  // One unknown signal, the old blink drew and erased the icon three times with delay() in between
+  Traffic directBlink = {};
+  Traffic bufferedBlink = {};
+
+  uint32_t transactions = directDisplay.transactions;
+  uint32_t bytes = directDisplay.bytesSent;
+
+  for (int i = 0; i < BLINK_COUNT; i++) {
+    directDisplay.drawRGBBitmap(ICON_POSITION_X, ICON_POSITION_Y, UNKNOWN_SIGNAL_BITMAP, ICON_SIZE_PIXELS, ICON_SIZE_PIXELS);
+    directDisplay.fillRect(ICON_POSITION_X, ICON_POSITION_Y, ICON_SIZE_PIXELS, ICON_SIZE_PIXELS, BACKGROUND_COLOR);
+  }
+  addTraffic(&directBlink, &directDisplay, transactions, bytes);
+
+  IrEvent unknown = { .protocol = UNKNOWN, .flags = 0, .address = 0, .command = 0, .timeMs = (uint32_t)millis() };
+  pushIrEvent(&unknown);
+
+  transactions = display.transactions;
+  bytes = display.bytesSent;
+
+  unsigned long blinkStart = millis();
+  while (millis() - blinkStart < BLINK_WAIT_MS) {
+    loop();
+    delay(1);
+  }
+  addTraffic(&bufferedBlink, &display, transactions, bytes);
+
+  // Erasing the icon must bring back the text and lines below it
+  drawDirect();
+  bool restored = differentPixels() == 0;
+
+  printf("signals: %d\n", signals);
+  printf("%-22s %8s %8s %10s %8s\n", "update", "trans", "max", "bytes", "max");
+  printTraffic("signal direct", &direct);
+  printTraffic("signal frame buffer", &buffered);
+  printTraffic("blink direct", &directBlink);
+  printTraffic("blink frame buffer", &bufferedBlink);
+  printf("compose + push: %.2f us per signal on the host\n", composeNanos / 1000.0 / signals);
+  printf("screens that differ: %d, restored after blink: %s\n", mismatches, restored ? "yes" : "no");
+  return mismatches == 0 && restored ? 0 : 2;
+}
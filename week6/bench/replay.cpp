@@ -0,0 +1,171 @@
+/*
+
+  Replay driver of the IR analytics, started with bench -r.
+
+  Generates synthetic signal streams and feeds them to recordIrAnalytics() on
+  its own and through the queue and loop(), one signal per loop() like signals
+  that arrive further apart than a redraw. Reports the time per signal and the
+  highest signal rate each path keeps up with.
+
+  .pio/build/native/program -r 100000
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#include <IRremoteInt.h>
+#include <time.h>
+
+#include <vector>
+
+#include "irAnalytics.h"
+#include "irEvents.h"
+
+// An NEC remote repeats a held key every 110 ms
+#define NEC_REPEAT_MS 110
+
+// Keys pressed on a few remotes, every press repeats a few times
+#define KEYPAD_REMOTES 3
+#define KEYPAD_KEYS 20
+#define KEYPAD_MAX_REPEATS 5
+#define KEYPAD_PRESS_GAP_MS 300
+
+enum Stream {
+  STREAM_HELD,
+  STREAM_KEYPAD,
+  STREAM_SCAN,
+  STREAM_COUNT
+};
+
+static const char* streamNames[STREAM_COUNT] = { "held key", "keypad", "scan" };
+
+void loop();
+
+static uint32_t replayRandomState;
+
+static uint32_t replayRandom() {
+  replayRandomState = replayRandomState * 1664525 + 1013904223;
+  return replayRandomState >> 8;
+}
+
+static uint64_t replayNanos() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void makeStream(Stream stream, int events, std::vector<IrEvent>* signals) {
+  signals->clear();
+
+  uint32_t timeMs = 0;
+  int repeatsLeft = 0;
+  IrEvent event = { .protocol = NEC, .flags = 0, .address = 0, .command = 0x45, .timeMs = 0 };
+
+  for (int i = 0; i < events; i++) {
+    if (stream == STREAM_HELD) {
+      // One key held down for the whole stream
+      event.flags = i == 0 ? 0 : IRDATA_FLAGS_IS_REPEAT;
+      timeMs += NEC_REPEAT_MS;
+    } else if (stream == STREAM_KEYPAD) {
+      if (repeatsLeft == 0) {
+        event.address = replayRandom() % KEYPAD_REMOTES;
+        event.command = replayRandom() % KEYPAD_KEYS;
+        event.flags = 0;
+        repeatsLeft = replayRandom() % KEYPAD_MAX_REPEATS;
+        timeMs += KEYPAD_PRESS_GAP_MS;
+      } else {
+        event.flags = IRDATA_FLAGS_IS_REPEAT;
+        repeatsLeft--;
+        timeMs += NEC_REPEAT_MS;
+      }
+    } else {
+      // Every signal is new, the table fills up and the rest is only counted in the rate
+      event.address = i >> 8;
+      event.command = i & 0xFF;
+      timeMs += 1;
+    }
+
+    event.timeMs = timeMs;
+    signals->push_back(event);
+  }
+}
+
+// Nanoseconds per signal of recordIrAnalytics(), a second pass times every signal for the slowest one in maxNanos
+static double timeAnalytics(const std::vector<IrEvent>& signals, uint64_t* maxNanos) {
+  resetIrAnalytics();
+  *maxNanos = 0;
+
+  for (size_t i = 0; i < signals.size(); i++) {
+    uint64_t signalStart = replayNanos();
+    recordIrAnalytics(&signals[i]);
+    *maxNanos = max(*maxNanos, replayNanos() - signalStart);
+  }
+
+  resetIrAnalytics();
+
+  uint64_t start = replayNanos();
+  for (size_t i = 0; i < signals.size(); i++) {
+    recordIrAnalytics(&signals[i]);
+  }
+  return (double)(replayNanos() - start) / signals.size();
+}
+
+// Nanoseconds per signal through the queue, loop() with the redraw and the push to the mock panel
+static double timeLoop(const std::vector<IrEvent>& signals) {
+  resetIrAnalytics();
+
+  uint64_t start = replayNanos();
+  for (size_t i = 0; i < signals.size(); i++) {
+    pushIrEvent(&signals[i]);
+    loop();
+  }
+  return (double)(replayNanos() - start) / signals.size();
+}
+
+// Checks what the analytics found in a stream against what the stream holds
+static bool checkStream(Stream stream, int events) {
+  const SignalCounter* const* top;
+  int topCount = getTopSignals(&top);
+
+  if (stream == STREAM_HELD) {
+    const SignalCounter* longest = getLongestBurst();
+    // One press held for the whole stream, its repeats stop counting at the largest 16 bit value
+    return topCount == 1 && top[0]->count == (uint32_t)events && longest == top[0] && top[0]->bursts == 1 &&
+           top[0]->longestBurst == min(events - 1, (int)UINT16_MAX);
+  }
+  if (stream == STREAM_SCAN) {
+    return trackedSignals() == min(events, ANALYTICS_MAX_KEYS) && untrackedSignals() == (uint32_t)(events - trackedSignals());
+  }
+
+  for (int i = 1; i < topCount; i++) {
+    if (top[i - 1]->count < top[i]->count) {
+      return false;
+    }
+  }
+  return topCount == min(ANALYTICS_TOP_SIZE, trackedSignals());
+}
+
+int runReplay(int events, uint32_t seed) {
+  replayRandomState = seed;
+  bool passed = true;
+
+  std::vector<IrEvent> signals;
+
+  printf("replay: %d signals per stream\n", events);
+  printf("%-10s %12s %12s %14s %12s %14s %6s\n", "stream", "record ns", "max ns", "record sig/s", "loop us", "loop sig/s", "check");
+
+  for (int stream = 0; stream < STREAM_COUNT; stream++) {
+    makeStream((Stream)stream, events, &signals);
+
+    uint64_t maxNanos;
+    double recordNanos = timeAnalytics(signals, &maxNanos);
+    bool checked = checkStream((Stream)stream, events);
+    double loopNanos = timeLoop(signals);
+
+    printf("%-10s %12.1f %12llu %14.0f %12.2f %14.0f %6s\n", streamNames[stream], recordNanos, (unsigned long long)maxNanos,
+           1e9 / recordNanos, loopNanos / 1000, 1e9 / loopNanos, checked ? "ok" : "FAIL");
+    passed = passed && checked;
+  }
+
+  return passed ? 0 : 2;
+}
@@ -0,0 +1,70 @@
+/*
+
+  Host stand-in for Adafruit_GFX, only what the sensor display uses.
+
+  Drawing goes through the same startWrite(), writePixel() and writeFillRect()
+  calls as the real library, so a display that counts them sees the same SPI
+  traffic. The font is a stand-in for the classic 5x7 font with only the
+  printable ASCII characters.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+class Adafruit_GFX {
+ public:
+  Adafruit_GFX(int16_t w, int16_t h);
+  virtual ~Adafruit_GFX() {}
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+  virtual void startWrite() {}
+  virtual void endWrite() {}
+  virtual void writePixel(int16_t x, int16_t y, uint16_t color);
+  virtual void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void fillScreen(uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+  void drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h);
+
+  // size 1 only, bg equal to color draws the glyph without its background
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+
+  void setCursor(int16_t x, int16_t y);
+  void setTextColor(uint16_t color);
+  void setTextWrap(bool w) { wrap = w; }
+  void print(const char* text);
+  int16_t getCursorX() const { return cursor_x; }
+  int16_t getCursorY() const { return cursor_y; }
+
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+ protected:
+  int16_t _width;
+  int16_t _height;
+  int16_t cursor_x;
+  int16_t cursor_y;
+  uint16_t textcolor;
+  bool wrap;
+};
+
+// Drawing into a RGB565 buffer in memory
+class GFXcanvas16 : public Adafruit_GFX {
+ public:
+  GFXcanvas16(uint16_t w, uint16_t h);
+  ~GFXcanvas16();
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  uint16_t* getBuffer() const { return buffer; }
+
+ private:
+  uint16_t* buffer;
+};
@@ -0,0 +1,48 @@
+/*
+
+  Host stand-in for Adafruit_SSD1331.
+  Keeps a copy of the panel memory so the result of both drawing paths can be
+  compared, and counts the SPI transactions and bytes they would send.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#pragma once
+
+#include <Adafruit_GFX.h>
+
+#define SSD1331_WIDTH 96
+#define SSD1331_HEIGHT 64
+
+// The address window command of the SSD1331 is 6 bytes: 0x15 x0 x1 0x75 y0 y1
+#define SSD1331_WINDOW_COMMAND_BYTES 6
+
+class Adafruit_SSD1331 : public Adafruit_GFX {
+ public:
+  Adafruit_SSD1331(int8_t cs, int8_t dc, int8_t mosi, int8_t sclk, int8_t rst);
+
+  void begin(uint32_t freq = 0);
+
+  // Like Adafruit_SPITFT every pixel and rectangle opens its own address window
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void startWrite() override;
+  void writePixel(int16_t x, int16_t y, uint16_t color) override;
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+
+  // Adafruit_SPITFT low level writes, pixels fill the window row by row
+  void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+  void writePixels(uint16_t* colors, uint32_t len, bool block = true, bool bigEndian = false);
+
+  // Panel memory, what the OLED would show right now
+  uint16_t gddram[SSD1331_WIDTH * SSD1331_HEIGHT];
+
+  // Bus counters, bytes include command bytes
+  uint32_t transactions;
+  uint32_t bytesSent;
+
+ private:
+  // Current address window and write position inside it
+  uint16_t windowX, windowY, windowW, windowH;
+  uint32_t windowPos;
+};
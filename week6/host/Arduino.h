@@ -0,0 +1,37 @@
+/*
+
+  Host stand-in for the Arduino core, only what the sensor display uses.
+  Compiled in the [env:native] build, never on the ESP32.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#define PROGMEM
+
+using std::max;
+using std::min;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+// Serial output goes to stderr so benchmark results on stdout stay clean
+class HardwareSerial {
+ public:
+  void begin(unsigned long baud);
+  void print(const char* s);
+  void println(const char* s);
+};
+
+extern HardwareSerial Serial;
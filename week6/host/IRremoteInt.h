@@ -0,0 +1,47 @@
+/*
+
+  Host stand-in for IRremoteInt.h, the protocol ids and their names.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#pragma once
+
+// IrReceiver.decodedIRData.flags of a repeat frame
+#define IRDATA_FLAGS_IS_REPEAT 0x01
+
+typedef enum {
+  UNKNOWN = 0,
+  PULSE_WIDTH,
+  PULSE_DISTANCE,
+  APPLE,
+  DENON,
+  JVC,
+  LG,
+  LG2,
+  NEC,
+  NEC2,
+  ONKYO,
+  PANASONIC,
+  KASEIKYO,
+  KASEIKYO_DENON,
+  KASEIKYO_SHARP,
+  KASEIKYO_JVC,
+  KASEIKYO_MITSUBISHI,
+  RC5,
+  RC6,
+  SAMSUNG,
+  SAMSUNG48,
+  SAMSUNGLG,
+  SHARP,
+  SONY,
+  BANG_OLUFSEN,
+  BOSEWAVE,
+  LEGO_PF,
+  MAGIQUEST,
+  WHYNTER,
+  FAST
+} decode_type_t;
+
+const char* getProtocolString(decode_type_t protocol);
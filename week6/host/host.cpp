@@ -0,0 +1,279 @@
+/*
+
+  Host implementation of the Arduino, Adafruit_GFX, SSD1331 and IRremote stand-ins.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#include <Adafruit_SSD1331.h>
+#include <Arduino.h>
+#include <IRremoteInt.h>
+#include <time.h>
+
+#define FONT_FIRST_CHAR ' '
+#define FONT_LAST_CHAR '~'
+
+// Columns of the 5x7 characters ' ' to '~', bit 0 is the top row
+static const uint8_t font[] = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5F, 0x00, 0x00, 0x00, 0x07, 0x00, 0x07, 0x00, 0x14, 0x7F, 0x14, 0x7F, 0x14,
+  0x24, 0x2A, 0x7F, 0x2A, 0x12, 0x23, 0x13, 0x08, 0x64, 0x62, 0x36, 0x49, 0x55, 0x22, 0x50, 0x00, 0x05, 0x03, 0x00, 0x00,
+  0x00, 0x1C, 0x22, 0x41, 0x00, 0x00, 0x41, 0x22, 0x1C, 0x00, 0x08, 0x2A, 0x1C, 0x2A, 0x08, 0x08, 0x08, 0x3E, 0x08, 0x08,
+  0x00, 0x50, 0x30, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x60, 0x60, 0x00, 0x00, 0x20, 0x10, 0x08, 0x04, 0x02,
+  0x3E, 0x51, 0x49, 0x45, 0x3E, 0x00, 0x42, 0x7F, 0x40, 0x00, 0x42, 0x61, 0x51, 0x49, 0x46, 0x21, 0x41, 0x45, 0x4B, 0x31,
+  0x18, 0x14, 0x12, 0x7F, 0x10, 0x27, 0x45, 0x45, 0x45, 0x39, 0x3C, 0x4A, 0x49, 0x49, 0x30, 0x01, 0x71, 0x09, 0x05, 0x03,
+  0x36, 0x49, 0x49, 0x49, 0x36, 0x06, 0x49, 0x49, 0x29, 0x1E, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x56, 0x36, 0x00, 0x00,
+  0x08, 0x14, 0x22, 0x41, 0x00, 0x14, 0x14, 0x14, 0x14, 0x14, 0x00, 0x41, 0x22, 0x14, 0x08, 0x02, 0x01, 0x51, 0x09, 0x06,
+  0x32, 0x49, 0x79, 0x41, 0x3E, 0x7E, 0x11, 0x11, 0x11, 0x7E, 0x7F, 0x49, 0x49, 0x49, 0x36, 0x3E, 0x41, 0x41, 0x41, 0x22,
+  0x7F, 0x41, 0x41, 0x22, 0x1C, 0x7F, 0x49, 0x49, 0x49, 0x41, 0x7F, 0x09, 0x09, 0x01, 0x01, 0x3E, 0x41, 0x41, 0x51, 0x32,
+  0x7F, 0x08, 0x08, 0x08, 0x7F, 0x00, 0x41, 0x7F, 0x41, 0x00, 0x20, 0x40, 0x41, 0x3F, 0x01, 0x7F, 0x08, 0x14, 0x22, 0x41,
+  0x7F, 0x40, 0x40, 0x40, 0x40, 0x7F, 0x02, 0x04, 0x02, 0x7F, 0x7F, 0x04, 0x08, 0x10, 0x7F, 0x3E, 0x41, 0x41, 0x41, 0x3E,
+  0x7F, 0x09, 0x09, 0x09, 0x06, 0x3E, 0x41, 0x51, 0x21, 0x5E, 0x7F, 0x09, 0x19, 0x29, 0x46, 0x46, 0x49, 0x49, 0x49, 0x31,
+  0x01, 0x01, 0x7F, 0x01, 0x01, 0x3F, 0x40, 0x40, 0x40, 0x3F, 0x1F, 0x20, 0x40, 0x20, 0x1F, 0x7F, 0x20, 0x18, 0x20, 0x7F,
+  0x63, 0x14, 0x08, 0x14, 0x63, 0x03, 0x04, 0x78, 0x04, 0x03, 0x61, 0x51, 0x49, 0x45, 0x43, 0x00, 0x7F, 0x41, 0x41, 0x00,
+  0x02, 0x04, 0x08, 0x10, 0x20, 0x00, 0x41, 0x41, 0x7F, 0x00, 0x04, 0x02, 0x01, 0x02, 0x04, 0x40, 0x40, 0x40, 0x40, 0x40,
+  0x00, 0x01, 0x02, 0x04, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x7F, 0x48, 0x44, 0x44, 0x38, 0x38, 0x44, 0x44, 0x44, 0x20,
+  0x38, 0x44, 0x44, 0x48, 0x7F, 0x38, 0x54, 0x54, 0x54, 0x18, 0x08, 0x7E, 0x09, 0x01, 0x02, 0x08, 0x14, 0x54, 0x54, 0x3C,
+  0x7F, 0x08, 0x04, 0x04, 0x78, 0x00, 0x44, 0x7D, 0x40, 0x00, 0x20, 0x40, 0x44, 0x3D, 0x00, 0x00, 0x7F, 0x10, 0x28, 0x44,
+  0x00, 0x41, 0x7F, 0x40, 0x00, 0x7C, 0x04, 0x18, 0x04, 0x78, 0x7C, 0x08, 0x04, 0x04, 0x78, 0x38, 0x44, 0x44, 0x44, 0x38,
+  0x7C, 0x14, 0x14, 0x14, 0x08, 0x08, 0x14, 0x14, 0x18, 0x7C, 0x7C, 0x08, 0x04, 0x04, 0x08, 0x48, 0x54, 0x54, 0x54, 0x20,
+  0x04, 0x3F, 0x44, 0x40, 0x20, 0x3C, 0x40, 0x40, 0x20, 0x7C, 0x1C, 0x20, 0x40, 0x20, 0x1C, 0x3C, 0x40, 0x30, 0x40, 0x3C,
+  0x44, 0x28, 0x10, 0x28, 0x44, 0x0C, 0x50, 0x50, 0x50, 0x3C, 0x44, 0x64, 0x54, 0x4C, 0x44, 0x00, 0x08, 0x36, 0x41, 0x00,
+  0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x41, 0x36, 0x08, 0x00, 0x08, 0x04, 0x08, 0x10, 0x08
+};
+
+static_assert(sizeof(font) == (FONT_LAST_CHAR - FONT_FIRST_CHAR + 1) * 5, "font needs 5 columns for every printable character");
+
+static const char* const protocolNames[] = {
+  "UNKNOWN", "PulseWidth", "PulseDistance", "Apple", "Denon", "JVC", "LG", "LG2", "NEC", "NEC2",
+  "Onkyo", "Panasonic", "Kaseikyo", "Kaseikyo_Denon", "Kaseikyo_Sharp", "Kaseikyo_JVC", "Kaseikyo_Mitsubishi",
+  "RC5", "RC6", "Samsung", "Samsung48", "SamsungLG", "Sharp", "Sony", "Bang&Olufsen", "BoseWave", "Lego",
+  "MagiQuest", "Whynter", "FAST"
+};
+
+HardwareSerial Serial;
+
+static uint64_t monotonicMicros() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static const uint64_t bootMicros = monotonicMicros();
+
+unsigned long millis() {
+  return (monotonicMicros() - bootMicros) / 1000;
+}
+
+unsigned long micros() {
+  return monotonicMicros() - bootMicros;
+}
+
+void delay(unsigned long ms) {
+  struct timespec ts = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000 };
+  nanosleep(&ts, NULL);
+}
+
+void HardwareSerial::begin(unsigned long baud) {}
+void HardwareSerial::print(const char* s) { fputs(s, stderr); }
+void HardwareSerial::println(const char* s) { fprintf(stderr, "%s\n", s); }
+
+const char* getProtocolString(decode_type_t protocol) {
+  if (protocol < 0 || protocol > FAST) {
+    return protocolNames[UNKNOWN];
+  }
+  return protocolNames[protocol];
+}
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h), cursor_x(0), cursor_y(0), textcolor(0xFFFF), wrap(true) {}
+
+void Adafruit_GFX::writePixel(int16_t x, int16_t y, uint16_t color) {
+  drawPixel(x, y, color);
+}
+
+void Adafruit_GFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t row = y; row < y + h; row++) {
+    for (int16_t column = x; column < x + w; column++) {
+      writePixel(column, row, color);
+    }
+  }
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  startWrite();
+  writeFillRect(x, y, w, h, color);
+  endWrite();
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) {
+  fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+// The layout only has straight lines, the others are drawn pixel by pixel
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  if (x0 == x1) {
+    drawFastVLine(x0, min(y0, y1), abs(y1 - y0) + 1, color);
+  } else if (y0 == y1) {
+    drawFastHLine(min(x0, x1), y0, abs(x1 - x0) + 1, color);
+  } else {
+    int steps = max(abs(x1 - x0), abs(y1 - y0));
+
+    startWrite();
+    for (int i = 0; i <= steps; i++) {
+      writePixel(x0 + (x1 - x0) * i / steps, y0 + (y1 - y0) * i / steps, color);
+    }
+    endWrite();
+  }
+}
+
+void Adafruit_GFX::drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h) {
+  startWrite();
+  for (int16_t row = 0; row < h; row++) {
+    for (int16_t column = 0; column < w; column++) {
+      writePixel(x + column, y + row, bitmap[row * w + column]);
+    }
+  }
+  endWrite();
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+  if (x >= _width || y >= _height || x + 6 <= 0 || y + 8 <= 0) {
+    return;
+  }
+
+  startWrite();
+  for (int column = 0; column < 5; column++) {
+    uint8_t line = c >= FONT_FIRST_CHAR && c <= FONT_LAST_CHAR ? font[(c - FONT_FIRST_CHAR) * 5 + column] : 0;
+
+    for (int row = 0; row < 8; row++, line >>= 1) {
+      if (line & 1) {
+        writePixel(x + column, y + row, color);
+      } else if (bg != color) {
+        writePixel(x + column, y + row, bg);
+      }
+    }
+  }
+
+  if (bg != color) {
+    writeFillRect(x + 5, y, 1, 8, bg);
+  }
+  endWrite();
+}
+
+void Adafruit_GFX::setCursor(int16_t x, int16_t y) {
+  cursor_x = x;
+  cursor_y = y;
+}
+
+void Adafruit_GFX::setTextColor(uint16_t color) {
+  textcolor = color;
+}
+
+void Adafruit_GFX::print(const char* text) {
+  for (const char* c = text; *c != '\0'; c++) {
+    if (*c == '\n') {
+      cursor_x = 0;
+      cursor_y += 8;
+      continue;
+    }
+
+    if (wrap && cursor_x + 6 > _width) {
+      cursor_x = 0;
+      cursor_y += 8;
+    }
+
+    drawChar(cursor_x, cursor_y, *c, textcolor, textcolor, 1);
+    cursor_x += 6;
+  }
+}
+
+GFXcanvas16::GFXcanvas16(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
+  buffer = (uint16_t*)calloc(w * h, sizeof(uint16_t));
+}
+
+GFXcanvas16::~GFXcanvas16() {
+  free(buffer);
+}
+
+void GFXcanvas16::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x >= 0 && y >= 0 && x < _width && y < _height) {
+    buffer[y * _width + x] = color;
+  }
+}
+
+Adafruit_SSD1331::Adafruit_SSD1331(int8_t cs, int8_t dc, int8_t mosi, int8_t sclk, int8_t rst)
+    : Adafruit_GFX(SSD1331_WIDTH, SSD1331_HEIGHT), gddram(), transactions(0), bytesSent(0),
+      windowX(0), windowY(0), windowW(SSD1331_WIDTH), windowH(SSD1331_HEIGHT), windowPos(0) {}
+
+void Adafruit_SSD1331::begin(uint32_t freq) {
+  memset(gddram, 0, sizeof(gddram));
+  transactions = 0;
+  bytesSent = 0;
+}
+
+void Adafruit_SSD1331::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  startWrite();
+  writePixel(x, y, color);
+  endWrite();
+}
+
+void Adafruit_SSD1331::startWrite() {
+  transactions++;
+}
+
+void Adafruit_SSD1331::writePixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) {
+    return;
+  }
+
+  setAddrWindow(x, y, 1, 1);
+  writePixels(&color, 1);
+}
+
+// Clipped like Adafruit_SPITFT, then one window with all pixels in it
+void Adafruit_SSD1331::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  int16_t x0 = max<int16_t>(x, 0);
+  int16_t y0 = max<int16_t>(y, 0);
+  int16_t x1 = min<int16_t>(x + w, _width);
+  int16_t y1 = min<int16_t>(y + h, _height);
+
+  if (x0 >= x1 || y0 >= y1) {
+    return;
+  }
+
+  setAddrWindow(x0, y0, x1 - x0, y1 - y0);
+  for (int32_t i = 0; i < (x1 - x0) * (y1 - y0); i++) {
+    writePixels(&color, 1);
+  }
+}
+
+void Adafruit_SSD1331::setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  windowX = x;
+  windowY = y;
+  windowW = w;
+  windowH = h;
+  windowPos = 0;
+  bytesSent += SSD1331_WINDOW_COMMAND_BYTES;
+}
+
+// The panel wraps inside the window like the real controller does
+void Adafruit_SSD1331::writePixels(uint16_t* colors, uint32_t len, bool block, bool bigEndian) {
+  for (uint32_t i = 0; i < len; i++) {
+    uint32_t pos = windowPos++ % (windowW * windowH);
+    uint16_t x = windowX + pos % windowW;
+    uint16_t y = windowY + pos / windowW;
+
+    if (x < SSD1331_WIDTH && y < SSD1331_HEIGHT) {
+      gddram[y * SSD1331_WIDTH + x] = colors[i];
+    }
+  }
+  bytesSent += len * sizeof(uint16_t);
+}
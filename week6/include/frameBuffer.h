@@ -0,0 +1,50 @@
+/*
+
+  Off-screen RGB565 frame buffer of the sensor display.
+
+  Text and icons are composited into the frame buffer in memory, every drawing
+  call grows one dirty box and pushFrame() sends that box to the SSD1331 in a
+  single address window and SPI transaction. Characters are copied from a glyph
+  atlas, the built in 5x7 font of Adafruit_GFX rasterized once into RGB565, in
+  place of setting every pixel of a character over SPI.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <Adafruit_SSD1331.h>
+
+#define FRAME_WIDTH 96
+#define FRAME_HEIGHT 64
+
+// Cell of one character of the built in font at text size 1
+#define CHAR_WIDTH_PIXELS 6
+#define CHAR_HEIGHT_PIXELS 8
+
+// The atlas holds the printable ASCII characters, others are drawn as a space
+#define ATLAS_FIRST_CHAR ' '
+#define ATLAS_LAST_CHAR '~'
+#define ATLAS_GLYPHS (ATLAS_LAST_CHAR - ATLAS_FIRST_CHAR + 1)
+
+// Rasterizes the glyph atlas in textColor and fills the frame with backgroundColor
+void beginFrameBuffer(uint16_t textColor, uint16_t backgroundColor);
+
+// All drawing is clipped to the frame
+void fillFrameRect(int x, int y, int width, int height, uint16_t color);
+
+// Draws the character cell at x, y, only the pixels of the glyph itself are written
+void drawFrameGlyph(int x, int y, char c);
+
+// Draws text from x, y and wraps at the right edge like Adafruit_GFX print()
+void drawFrameText(int x, int y, const char* text);
+
+// Draws bitmap over the frame, pixels equal to the transparent color keep what is below them
+void blendFrameBitmap(int x, int y, const uint16_t* bitmap, int width, int height, uint16_t transparentColor);
+
+const uint16_t* getFrame();
+
+// Sends the dirty box to display in one address window, does nothing when nothing changed
+void pushFrame(Adafruit_SSD1331* display);
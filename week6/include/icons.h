@@ -0,0 +1,42 @@
+/*
+
+  Icons of the sensor display, RGB565 bitmaps on the black background color.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#define ICON_SIZE_PIXELS 20
+
+// Shown when a signal with an unknown protocol is received
+static const uint16_t UNKNOWN_SIGNAL_BITMAP[] PROGMEM = {
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9000, 0x7000,
+  0x0000, 0x0800, 0x7000, 0xa800, 0xd000, 0xf000, 0xf000, 0xd800, 0xc000, 0x8800, 0x4000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0xa000, 0xf800, 0x7000, 0x0000, 0x6800, 0xf800, 0xf800, 0xf800, 0xf800, 0xf800, 0xf800, 0xf800, 0xf800, 0xe800,
+  0x7800, 0x0800, 0x0000, 0x0000, 0x0000, 0x2000, 0xc800, 0xf800, 0xf800, 0x7000, 0x0000, 0x2800, 0x0800, 0x0000, 0x0800, 0x2800,
+  0x4800, 0x9800, 0xe800, 0xf800, 0xf800, 0xe800, 0x4000, 0x0000, 0x6000, 0xf800, 0xf800, 0xe800, 0xc000, 0xf800, 0x7000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x6000, 0xd800, 0xf800, 0xf800, 0x6000, 0x8000, 0xf800, 0x7000, 0x0800,
+  0x0000, 0xb000, 0xf800, 0x7800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9800, 0xf800, 0x8000,
+  0x0000, 0x3800, 0x0000, 0x0000, 0x0000, 0x0000, 0xd000, 0xf800, 0x7800, 0x0000, 0x5000, 0xc800, 0x9000, 0x4000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x4800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x3000, 0xd800, 0xf800, 0xf800, 0xf800, 0x8000, 0x0000, 0x6000,
+  0xf800, 0xf800, 0xc800, 0x3800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x2800, 0xf800, 0xf800, 0xe000, 0x7000,
+  0xa000, 0xf800, 0x8000, 0x0000, 0x5800, 0xd800, 0xf800, 0xf800, 0x2800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x8000, 0x9800, 0x0800, 0x0000, 0x0000, 0xa000, 0xf800, 0x8000, 0x0000, 0x0000, 0x8000, 0x8000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xa800, 0xf800, 0x8800, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x4800, 0xd000, 0xd800, 0xf000,
+  0xf800, 0x8800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0xe800, 0xf800, 0xf800, 0xe000, 0xa800, 0xf800, 0x8800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0xe000, 0xf800, 0xf800, 0xe000, 0x0000, 0xa800, 0xf800, 0x9000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x5000, 0xf800, 0xf800, 0x5000, 0x0000, 0x0000, 0xb000, 0xf800,
+  0x9000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0xb000, 0xa800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+};
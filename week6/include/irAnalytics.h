@@ -0,0 +1,65 @@
+/*
+
+  Statistics of the received IR signals.
+
+  Every (protocol, address, command) gets a counter in an open addressing hash
+  table of fixed size. Next to it the decode rate is kept in one counter per
+  second over a sliding window, held down keys are found from their repeats and
+  the most received signals are kept sorted in a short top list. Recording a
+  signal takes constant time, so held keys never make loop() fall behind.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "irEvents.h"
+
+// Power of two, filled up to ANALYTICS_MAX_KEYS so probes stay short
+#define ANALYTICS_TABLE_SIZE 256
+#define ANALYTICS_MAX_KEYS 192
+
+#define ANALYTICS_TOP_SIZE 4
+
+// Seconds of decode rate that are kept, rates can be asked for any window up to this
+#define ANALYTICS_WINDOW_SECONDS 60
+
+// An NEC remote repeats a held key every 110 ms, a longer gap is a new press
+#define REPEAT_GAP_MS 150
+
+// Repeats of one signal before it counts as a held key
+#define BURST_MIN_REPEATS 3
+
+typedef struct {
+  uint8_t protocol;
+  uint16_t address;
+  uint16_t command;
+  uint32_t count;
+  uint32_t lastMs;
+  uint16_t bursts;
+  uint16_t longestBurst;
+} SignalCounter;
+
+void resetIrAnalytics();
+
+// Counts the signal, signals that do not fit in the table anymore are only counted in the rate
+void recordIrAnalytics(const IrEvent* event);
+
+// Most received signals first, returns how many there are
+int getTopSignals(const SignalCounter* const** top);
+
+// Signals received in the last seconds seconds up to nowMs, seconds is at most ANALYTICS_WINDOW_SECONDS
+uint32_t signalsInWindow(uint32_t nowMs, int seconds);
+
+// The key that is held down right now and its repeats so far, NULL when no key is held
+const SignalCounter* getHeldSignal(uint32_t nowMs, int* repeats);
+
+// The signal with the longest run of repeats, NULL before the first signal
+const SignalCounter* getLongestBurst();
+
+// Different signals in the table and signals that did not fit in it
+int trackedSignals();
+uint32_t untrackedSignals();
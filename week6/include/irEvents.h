@@ -0,0 +1,44 @@
+/*
+
+  Queue of decoded IR signals between the IR task and the display loop.
+
+  A task polls the IR receiver, pushes every decoded signal into a lock free
+  ring buffer and resumes the receiver straight away, so no signal is lost while
+  the display is being drawn. loop() pops the signals on its own schedule.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+// Power of two, holds far more signals than a remote sends during one redraw
+#define IR_EVENT_QUEUE_SIZE 64
+
+// The IR task checks the receiver every tick, an NEC frame takes 68 ms
+#define IR_TASK_STACK_SIZE 4096
+#define IR_TASK_PRIORITY 2
+#define IR_TASK_CORE 0
+#define IR_POLL_INTERVAL_MS 1
+
+typedef struct {
+  uint8_t protocol;
+  uint8_t flags;
+  uint16_t address;
+  uint16_t command;
+  uint32_t timeMs;
+} IrEvent;
+
+// Starts the receiver and the task that decodes into the queue
+void startIrEvents(int receivePin);
+
+// Producer side, only called by the IR task or a replay driver. False when the queue is full
+bool pushIrEvent(const IrEvent* event);
+
+// Consumer side, only called by loop(). False when the queue is empty
+bool popIrEvent(IrEvent* event);
+
+// Signals lost because the queue was full
+uint32_t droppedIrEvents();
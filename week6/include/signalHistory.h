@@ -0,0 +1,42 @@
+/*
+
+  Fixed size history of the received IR signals.
+
+  Signals are kept in a ring buffer that overwrites the oldest signal once it
+  is full. Only the protocol id is stored, protocolName() resolves it to the
+  static name of IRremote, so adding and reading signals never touches the heap.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "irEvents.h"
+
+// Power of two, the screen only shows the newest few
+#define SIGNAL_HISTORY_SIZE 256
+
+// Characters of the protocol name that fit next to the labels on the screen
+#define PROTOCOL_NAME_LENGTH 5
+
+typedef struct {
+  uint8_t protocol;
+  uint16_t command;
+  uint16_t address;
+  uint32_t timeMs;
+} Signal;
+
+// Stores the signal of event, overwrites the oldest signal when the history is full
+void addSignal(const IrEvent* event);
+
+// Number of signals in the history, at most SIGNAL_HISTORY_SIZE
+int signalHistoryCount();
+
+// Signal received age signals before the newest one, age 0 is the newest
+const Signal* getRecentSignal(int age);
+
+// Static name of the protocol, print at most PROTOCOL_NAME_LENGTH characters of it
+const char* protocolName(uint8_t protocol);
@@ -0,0 +1,59 @@
+/*
+
+  Retained widgets of the sensor display.
+
+  Every text widget remembers the text that is on the screen. When its data
+  changes only the character cells that differ are cleared and drawn again, and
+  the parts of the layout lines inside a cleared cell are repaired. Widgets draw
+  into the frame buffer, pushFrame() sends what they changed.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "frameBuffer.h"
+
+// Longest text of a data field or recent signal line, with room for every number it can show.
+// The screen fits 16 characters per line and clips the rest
+#define DATA_STRING_SIZE 24
+
+enum Direction {
+  Horizontal,
+  Vertical
+};
+
+typedef struct {
+  int x;
+  int y;
+  int length;
+  Direction direction;
+} Line;
+
+// Text widget, data is written by the caller and shown is what is on the screen
+typedef struct {
+  int x;
+  int y;
+  const char* label;
+  char data[DATA_STRING_SIZE];
+  char shown[DATA_STRING_SIZE];
+} DataDisplayObject;
+
+// The widgets keep using objects and lines, the lines are repaired whenever a cell on top of them is cleared
+void beginWidgets(DataDisplayObject* objects, int count, const Line* lines, int lineCount, uint16_t lineColor, uint16_t backgroundColor);
+
+// Clears the screen and draws the lines and every widget with its current data
+void drawAllWidgets();
+
+// Redraws the cells of every widget whose data differs from what is shown
+void updateWidgets();
+
+// Clears the box and draws the lines and shown text inside it again, erases anything drawn on top of the widgets
+void restoreWidgetArea(int x, int y, int width, int height);
+
+// The widgets and lines passed to beginWidgets(), for tools that draw them another way
+const DataDisplayObject* getWidgets(int* count);
+const Line* getWidgetLines(int* lineCount);
@@ -0,0 +1,151 @@
+/*
+
+  Off-screen RGB565 frame buffer of the sensor display.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#include "frameBuffer.h"
+
+static uint16_t frame[FRAME_WIDTH * FRAME_HEIGHT];
+
+// Glyph i of the atlas is the character cell at x = i * CHAR_WIDTH_PIXELS
+static GFXcanvas16 glyphAtlas(ATLAS_GLYPHS * CHAR_WIDTH_PIXELS, CHAR_HEIGHT_PIXELS);
+static uint16_t atlasBackgroundColor;
+
+// Dirty box [dirtyX0, dirtyX1) x [dirtyY0, dirtyY1), empty when dirtyX0 >= dirtyX1
+static int dirtyX0 = 0;
+static int dirtyY0 = 0;
+static int dirtyX1 = 0;
+static int dirtyY1 = 0;
+
+static void markDirty(int x0, int y0, int x1, int y1) {
+  if (dirtyX0 >= dirtyX1) {
+    dirtyX0 = x0;
+    dirtyY0 = y0;
+    dirtyX1 = x1;
+    dirtyY1 = y1;
+    return;
+  }
+
+  dirtyX0 = min(dirtyX0, x0);
+  dirtyY0 = min(dirtyY0, y0);
+  dirtyX1 = max(dirtyX1, x1);
+  dirtyY1 = max(dirtyY1, y1);
+}
+
+// Clips the box at x, y to the frame, false when nothing of it is left
+static bool clipBox(int x, int y, int width, int height, int* x0, int* y0, int* x1, int* y1) {
+  *x0 = max(x, 0);
+  *y0 = max(y, 0);
+  *x1 = min(x + width, FRAME_WIDTH);
+  *y1 = min(y + height, FRAME_HEIGHT);
+
+  return *x0 < *x1 && *y0 < *y1;
+}
+
+void beginFrameBuffer(uint16_t textColor, uint16_t backgroundColor) {
+  atlasBackgroundColor = backgroundColor;
+
+  glyphAtlas.fillScreen(backgroundColor);
+  for (int i = 0; i < ATLAS_GLYPHS; i++) {
+    glyphAtlas.drawChar(i * CHAR_WIDTH_PIXELS, 0, ATLAS_FIRST_CHAR + i, textColor, backgroundColor, 1);
+  }
+
+  fillFrameRect(0, 0, FRAME_WIDTH, FRAME_HEIGHT, backgroundColor);
+}
+
+void fillFrameRect(int x, int y, int width, int height, uint16_t color) {
+  int x0, y0, x1, y1;
+  if (!clipBox(x, y, width, height, &x0, &y0, &x1, &y1)) {
+    return;
+  }
+
+  for (int row = y0; row < y1; row++) {
+    uint16_t* pixel = &frame[row * FRAME_WIDTH];
+
+    for (int column = x0; column < x1; column++) {
+      pixel[column] = color;
+    }
+  }
+
+  markDirty(x0, y0, x1, y1);
+}
+
+// Copies the pixels of the box that are not transparent, source has stride pixels per row
+static void blendBox(int x, int y, const uint16_t* source, int stride, int width, int height, uint16_t transparentColor) {
+  int x0, y0, x1, y1;
+  if (!clipBox(x, y, width, height, &x0, &y0, &x1, &y1)) {
+    return;
+  }
+
+  for (int row = y0; row < y1; row++) {
+    const uint16_t* sourcePixel = &source[(row - y) * stride + x0 - x];
+    uint16_t* pixel = &frame[row * FRAME_WIDTH + x0];
+
+    for (int i = 0; i < x1 - x0; i++) {
+      if (sourcePixel[i] != transparentColor) {
+        pixel[i] = sourcePixel[i];
+      }
+    }
+  }
+
+  markDirty(x0, y0, x1, y1);
+}
+
+void drawFrameGlyph(int x, int y, char c) {
+  if (c < ATLAS_FIRST_CHAR || c > ATLAS_LAST_CHAR) {
+    c = ' ';
+  }
+
+  const uint16_t* glyph = glyphAtlas.getBuffer() + (c - ATLAS_FIRST_CHAR) * CHAR_WIDTH_PIXELS;
+  blendBox(x, y, glyph, glyphAtlas.width(), CHAR_WIDTH_PIXELS, CHAR_HEIGHT_PIXELS, atlasBackgroundColor);
+}
+
+void drawFrameText(int x, int y, const char* text) {
+  int cursorX = x;
+  int cursorY = y;
+
+  for (const char* c = text; *c != '\0'; c++) {
+    if (cursorX + CHAR_WIDTH_PIXELS > FRAME_WIDTH) {
+      cursorX = 0;
+      cursorY += CHAR_HEIGHT_PIXELS;
+    }
+
+    drawFrameGlyph(cursorX, cursorY, *c);
+    cursorX += CHAR_WIDTH_PIXELS;
+  }
+}
+
+void blendFrameBitmap(int x, int y, const uint16_t* bitmap, int width, int height, uint16_t transparentColor) {
+  blendBox(x, y, bitmap, width, width, height, transparentColor);
+}
+
+const uint16_t* getFrame() {
+  return frame;
+}
+
+void pushFrame(Adafruit_SSD1331* display) {
+  if (dirtyX0 >= dirtyX1) {
+    return;
+  }
+
+  int width = dirtyX1 - dirtyX0;
+
+  display->startWrite();
+  display->setAddrWindow(dirtyX0, dirtyY0, width, dirtyY1 - dirtyY0);
+
+  // Full width rows are one block of memory, otherwise the window takes the rows one after another
+  if (width == FRAME_WIDTH) {
+    display->writePixels(&frame[dirtyY0 * FRAME_WIDTH], width * (dirtyY1 - dirtyY0));
+  } else {
+    for (int row = dirtyY0; row < dirtyY1; row++) {
+      display->writePixels(&frame[row * FRAME_WIDTH + dirtyX0], width);
+    }
+  }
+
+  display->endWrite();
+
+  dirtyX1 = dirtyX0;
+}
@@ -0,0 +1,189 @@
+/*
+
+  Statistics of the received IR signals.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#include "irAnalytics.h"
+
+#include <IRremoteInt.h>
+
+static_assert((ANALYTICS_TABLE_SIZE & (ANALYTICS_TABLE_SIZE - 1)) == 0, "ANALYTICS_TABLE_SIZE must be a power of two");
+static_assert(ANALYTICS_MAX_KEYS < ANALYTICS_TABLE_SIZE, "the table needs empty slots to end a probe");
+
+// A slot is empty while its count is 0
+static SignalCounter counters[ANALYTICS_TABLE_SIZE];
+static int keyCount = 0;
+static uint32_t untracked = 0;
+
+// Sorted by count, every counter outside the list has a count of at most the last one in it
+static SignalCounter* top[ANALYTICS_TOP_SIZE];
+static int topCount = 0;
+
+// Signals per second, bucket (second % ANALYTICS_WINDOW_SECONDS) belongs to currentSecond and the seconds before it
+static uint32_t secondBuckets[ANALYTICS_WINDOW_SECONDS];
+static uint32_t currentSecond = 0;
+
+// The run of repeats of the last signal
+static SignalCounter* runCounter = NULL;
+static uint32_t runLastMs = 0;
+static int runRepeats = 0;
+
+static SignalCounter* longestBurstCounter = NULL;
+
+void resetIrAnalytics() {
+  memset(counters, 0, sizeof(counters));
+  memset(secondBuckets, 0, sizeof(secondBuckets));
+  keyCount = 0;
+  untracked = 0;
+  topCount = 0;
+  currentSecond = 0;
+  runCounter = NULL;
+  runLastMs = 0;
+  runRepeats = 0;
+  longestBurstCounter = NULL;
+}
+
+static uint32_t hashSignal(uint8_t protocol, uint16_t address, uint16_t command) {
+  uint64_t key = (uint64_t)protocol << 32 | (uint32_t)address << 16 | command;
+  return (key * 0x9E3779B97F4A7C15ull) >> 32;
+}
+
+// The counter of the signal, a new one when it is not in the table yet, NULL when the table is full
+static SignalCounter* findCounter(const IrEvent* event) {
+  uint32_t slot = hashSignal(event->protocol, event->address, event->command);
+
+  for (;; slot++) {
+    SignalCounter* counter = &counters[slot % ANALYTICS_TABLE_SIZE];
+
+    if (counter->count == 0) {
+      if (keyCount == ANALYTICS_MAX_KEYS) {
+        return NULL;
+      }
+
+      counter->protocol = event->protocol;
+      counter->address = event->address;
+      counter->command = event->command;
+      keyCount++;
+      return counter;
+    }
+
+    if (counter->protocol == event->protocol && counter->address == event->address && counter->command == event->command) {
+      return counter;
+    }
+  }
+}
+
+// Moves the counter that just went up by one to its place in the top list
+static void updateTop(SignalCounter* counter) {
+  int i = 0;
+  while (i < topCount && top[i] != counter) {
+    i++;
+  }
+
+  if (i == topCount) {
+    if (topCount < ANALYTICS_TOP_SIZE) {
+      topCount++;
+    } else if (counter->count <= top[topCount - 1]->count) {
+      return;
+    } else {
+      i = topCount - 1;
+    }
+    top[i] = counter;
+  }
+
+  for (; i > 0 && top[i - 1]->count < counter->count; i--) {
+    top[i] = top[i - 1];
+    top[i - 1] = counter;
+  }
+}
+
+// Moves the window to second, the buckets of the seconds in between are emptied
+static void advanceWindow(uint32_t second) {
+  if (second <= currentSecond) {
+    return;
+  }
+
+  uint32_t passed = min<uint32_t>(second - currentSecond, ANALYTICS_WINDOW_SECONDS);
+  for (uint32_t i = 1; i <= passed; i++) {
+    secondBuckets[(currentSecond + i) % ANALYTICS_WINDOW_SECONDS] = 0;
+  }
+  currentSecond = second;
+}
+
+void recordIrAnalytics(const IrEvent* event) {
+  // A signal from a second that already left the window still counts in the current one
+  advanceWindow(event->timeMs / 1000);
+  secondBuckets[currentSecond % ANALYTICS_WINDOW_SECONDS]++;
+
+  SignalCounter* counter = findCounter(event);
+  if (counter == NULL) {
+    untracked++;
+    runCounter = NULL;
+    return;
+  }
+
+  bool repeat = counter == runCounter && ((event->flags & IRDATA_FLAGS_IS_REPEAT) || event->timeMs - runLastMs <= REPEAT_GAP_MS);
+
+  // The counters of a burst are 16 bit, a key held longer stays at the largest count
+  runRepeats = repeat ? min(runRepeats + 1, (int)UINT16_MAX) : 0;
+  runCounter = counter;
+  runLastMs = event->timeMs;
+
+  if (runRepeats == BURST_MIN_REPEATS && counter->bursts < UINT16_MAX) {
+    counter->bursts++;
+  }
+  if (runRepeats > counter->longestBurst) {
+    counter->longestBurst = runRepeats;
+  }
+  if (longestBurstCounter == NULL || counter->longestBurst > longestBurstCounter->longestBurst) {
+    longestBurstCounter = counter;
+  }
+
+  counter->count++;
+  counter->lastMs = event->timeMs;
+  updateTop(counter);
+}
+
+int getTopSignals(const SignalCounter* const** topSignals) {
+  *topSignals = top;
+  return topCount;
+}
+
+uint32_t signalsInWindow(uint32_t nowMs, int seconds) {
+  advanceWindow(nowMs / 1000);
+
+  // There are no seconds before the first one
+  uint32_t windowSeconds = min<uint32_t>(min(seconds, ANALYTICS_WINDOW_SECONDS), currentSecond + 1);
+
+  uint32_t signals = 0;
+  for (uint32_t i = 0; i < windowSeconds; i++) {
+    signals += secondBuckets[(currentSecond - i) % ANALYTICS_WINDOW_SECONDS];
+  }
+  return signals;
+}
+
+const SignalCounter* getHeldSignal(uint32_t nowMs, int* repeats) {
+  // An event stamped after nowMs was read counts as no time passed
+  uint32_t sinceLastMs = nowMs > runLastMs ? nowMs - runLastMs : 0;
+  if (runCounter == NULL || runRepeats < BURST_MIN_REPEATS || sinceLastMs > REPEAT_GAP_MS) {
+    return NULL;
+  }
+
+  *repeats = runRepeats;
+  return runCounter;
+}
+
+const SignalCounter* getLongestBurst() {
+  return longestBurstCounter;
+}
+
+int trackedSignals() {
+  return keyCount;
+}
+
+uint32_t untrackedSignals() {
+  return untracked;
+}
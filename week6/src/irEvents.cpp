@@ -0,0 +1,87 @@
+/*
+
+  Lock free single producer, single consumer ring of decoded IR signals.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#include "irEvents.h"
+
+#include <atomic>
+
+#if defined(ESP32)
+#include <IRremote.hpp>
+#endif
+
+static_assert((IR_EVENT_QUEUE_SIZE & (IR_EVENT_QUEUE_SIZE - 1)) == 0, "IR_EVENT_QUEUE_SIZE must be a power of two");
+
+static IrEvent irEventQueue[IR_EVENT_QUEUE_SIZE];
+
+// Free running indices, head is only written by the producer and tail by the consumer
+static std::atomic<uint32_t> irEventHead(0);
+static std::atomic<uint32_t> irEventTail(0);
+static std::atomic<uint32_t> irEventsDropped(0);
+
+bool pushIrEvent(const IrEvent* event) {
+  uint32_t head = irEventHead.load(std::memory_order_relaxed);
+
+  if (head - irEventTail.load(std::memory_order_acquire) == IR_EVENT_QUEUE_SIZE) {
+    irEventsDropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  irEventQueue[head % IR_EVENT_QUEUE_SIZE] = *event;
+  irEventHead.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+bool popIrEvent(IrEvent* event) {
+  uint32_t tail = irEventTail.load(std::memory_order_relaxed);
+
+  if (tail == irEventHead.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  *event = irEventQueue[tail % IR_EVENT_QUEUE_SIZE];
+  irEventTail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+uint32_t droppedIrEvents() {
+  return irEventsDropped.load(std::memory_order_relaxed);
+}
+
+#if defined(ESP32)
+
+// Decodes every finished IR frame and resumes the receiver before anything is drawn
+static void irTask(void* parameters) {
+  for (;;) {
+    if (IrReceiver.decode()) {
+      IrEvent event = {
+        .protocol = (uint8_t)IrReceiver.decodedIRData.protocol,
+        .flags = (uint8_t)IrReceiver.decodedIRData.flags,
+        .address = IrReceiver.decodedIRData.address,
+        .command = IrReceiver.decodedIRData.command,
+        .timeMs = millis()
+      };
+
+      IrReceiver.resume();
+      pushIrEvent(&event);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(IR_POLL_INTERVAL_MS));
+  }
+}
+
+void startIrEvents(int receivePin) {
+  IrReceiver.begin(receivePin);
+  xTaskCreatePinnedToCore(irTask, "ir", IR_TASK_STACK_SIZE, NULL, IR_TASK_PRIORITY, NULL, IR_TASK_CORE);
+}
+
+#else
+
+// The host build has no receiver, a replay driver pushes the events
+void startIrEvents(int receivePin) {}
+
+#endif
@@ -13,7 +13,14 @@
 
 #include <Arduino.h>
 #include <Adafruit_SSD1331.h>
-#include <IRremote.hpp>
+#include <IRremoteInt.h>
+
+#include "frameBuffer.h"
+#include "icons.h"
+#include "irAnalytics.h"
+#include "irEvents.h"
+#include "signalHistory.h"
+#include "widgets.h"
 
 // Define pin numbers of SSD1331 for SPI (Serial Peripheral Interface) communication
 #define CS_PIN 5
@@ -33,72 +40,32 @@
 
 #define SERIAL_MONITOR_BAUD_RATE 115200
 
-#define LINE_HEIGHT_PIXELS 8
-
 #define RECENT_SIGNAL_SIZE 4
 
+// Larger counts of a top signal show as this, five digits leave room for the rest of the line
+#define SHOWN_COUNT_MAX 99999
+
 #define ICON_POSITION_X 74
 #define ICON_POSITION_Y 44
-#define ICON_SIZE_PIXELS 20
 
-enum Direction {
-  Horizontal,
-  Vertical
-};
+#define BLINK_COUNT 3
+#define BLINK_INTERVAL_MS 100
 
-typedef struct {
-  char* protocol;
-  int command;
-  int address;
-} Signal;
-
-typedef struct {
-  int x;
-  int y;
-  int length;
-  Direction direction;
-} Line;
-
-typedef struct {
-  int x;
-  int y;
-  String label;
-  String data;
-} DataDisplayObject;
-
-const uint16_t UNKNOWN_SIGNAL_BITMAP[] PROGMEM = {
-  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9000, 0x7000,
-  0x0000, 0x0800, 0x7000, 0xa800, 0xd000, 0xf000, 0xf000, 0xd800, 0xc000, 0x8800, 0x4000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-  0x0000, 0x0000, 0xa000, 0xf800, 0x7000, 0x0000, 0x6800, 0xf800, 0xf800, 0xf800, 0xf800, 0xf800, 0xf800, 0xf800, 0xf800, 0xe800,
-  0x7800, 0x0800, 0x0000, 0x0000, 0x0000, 0x2000, 0xc800, 0xf800, 0xf800, 0x7000, 0x0000, 0x2800, 0x0800, 0x0000, 0x0800, 0x2800,
-  0x4800, 0x9800, 0xe800, 0xf800, 0xf800, 0xe800, 0x4000, 0x0000, 0x6000, 0xf800, 0xf800, 0xe800, 0xc000, 0xf800, 0x7000, 0x0000,
-  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x6000, 0xd800, 0xf800, 0xf800, 0x6000, 0x8000, 0xf800, 0x7000, 0x0800,
-  0x0000, 0xb000, 0xf800, 0x7800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9800, 0xf800, 0x8000,
-  0x0000, 0x3800, 0x0000, 0x0000, 0x0000, 0x0000, 0xd000, 0xf800, 0x7800, 0x0000, 0x5000, 0xc800, 0x9000, 0x4000, 0x0000, 0x0000,
-  0x0000, 0x0000, 0x4800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x3000, 0xd800, 0xf800, 0xf800, 0xf800, 0x8000, 0x0000, 0x6000,
-  0xf800, 0xf800, 0xc800, 0x3800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x2800, 0xf800, 0xf800, 0xe000, 0x7000,
-  0xa000, 0xf800, 0x8000, 0x0000, 0x5800, 0xd800, 0xf800, 0xf800, 0x2800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-  0x8000, 0x9800, 0x0800, 0x0000, 0x0000, 0xa000, 0xf800, 0x8000, 0x0000, 0x0000, 0x8000, 0x8000, 0x0000, 0x0000, 0x0000, 0x0000,
-  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xa800, 0xf800, 0x8800, 0x0000, 0x0000, 0x0000,
-  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x4800, 0xd000, 0xd800, 0xf000,
-  0xf800, 0x8800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-  0xe800, 0xf800, 0xf800, 0xe000, 0xa800, 0xf800, 0x8800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-  0x0000, 0x0000, 0x0000, 0x0000, 0xe000, 0xf800, 0xf800, 0xe000, 0x0000, 0xa800, 0xf800, 0x9000, 0x0000, 0x0000, 0x0000, 0x0000,
-  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x5000, 0xf800, 0xf800, 0x5000, 0x0000, 0x0000, 0xb000, 0xf800,
-  0x9000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-  0x0000, 0x0000, 0x0000, 0xb000, 0xa800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0800, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+// Without new signals the screen changes to the analytics page, which is refreshed every second
+#define ANALYTICS_PAGE_IDLE_MS 5000
+#define ANALYTICS_REFRESH_MS 1000
+
+// Window of the decode rate on the analytics page
+#define RATE_WINDOW_SECONDS 10
+
+enum Page {
+  SignalPage,
+  AnalyticsPage
 };
 
 // Initialize Adafruit_SSD1331
 Adafruit_SSD1331 display(CS_PIN, DC_PIN, DIN_PIN, CLK_PIN, RES_PIN);
 
-Signal recentSignals[RECENT_SIGNAL_SIZE];
-
 const Line LAYOUT[] = {
   { .x = 0, .y = 9, .length = display.width(), .direction = Horizontal },
   { .x = 0, .y = 29, .length = display.width(), .direction = Horizontal },
@@ -112,13 +79,51 @@ DataDisplayObject DATA_DISPLAY_OBJECTS[] = {
   { .x = 0, .y = 20, .label = "Com:", .data = "" },
   { .x = 48, .y = 20, .label = "Add:", .data = "" },
   { .x = 75, .y = 32, .label = "", .data = "" },
+  { .x = 0, .y = 32, .label = "", .data = "" },
+  { .x = 0, .y = 40, .label = "", .data = "" },
+  { .x = 0, .y = 48, .label = "", .data = "" },
+  { .x = 0, .y = 56, .label = "", .data = "" },
+};
+
+// The recent signal lines follow the data fields, newest first
+const int RECENT_SIGNAL_OBJECT = 5;
+
+const Line ANALYTICS_LAYOUT[] = {
+  { .x = 0, .y = 9, .length = display.width(), .direction = Horizontal },
+  { .x = 0, .y = 29, .length = display.width(), .direction = Horizontal }
+};
+
+DataDisplayObject ANALYTICS_DISPLAY_OBJECTS[] = {
+  { .x = 0, .y = 0, .label = "Per sec ", .data = "" },
+  { .x = 0, .y = 12, .label = "Last min ", .data = "" },
+  { .x = 0, .y = 20, .label = "Held ", .data = "" },
+  { .x = 0, .y = 32, .label = "", .data = "" },
+  { .x = 0, .y = 40, .label = "", .data = "" },
+  { .x = 0, .y = 48, .label = "", .data = "" },
+  { .x = 0, .y = 56, .label = "", .data = "" },
 };
 
+// The most received signals follow the rates, one line each
+const int TOP_SIGNAL_OBJECT = 3;
+
 const int DISPLAY_SIZE = sizeof(DATA_DISPLAY_OBJECTS) / sizeof(DATA_DISPLAY_OBJECTS[0]);
 const int LAYOUT_SIZE = sizeof(LAYOUT) / sizeof(LAYOUT[0]);
+const int ANALYTICS_DISPLAY_SIZE = sizeof(ANALYTICS_DISPLAY_OBJECTS) / sizeof(ANALYTICS_DISPLAY_OBJECTS[0]);
+const int ANALYTICS_LAYOUT_SIZE = sizeof(ANALYTICS_LAYOUT) / sizeof(ANALYTICS_LAYOUT[0]);
 
 int signalInputCounter = 0;
 
+// The layout is drawn with the first signal, until then the waiting message is shown
+bool layoutDrawn = false;
+Page shownPage = SignalPage;
+
+unsigned long lastSignalMs = 0;
+unsigned long lastAnalyticsMs = 0;
+
+// Step of the unknown signal blink, even steps blend the icon into the frame and odd steps restore the widgets below it
+int blinkStep = BLINK_COUNT * 2;
+unsigned long blinkStartMs = 0;
+
 // Returns time since ESP was turned on in HH:MM:SS format
 char* getCurrentTime() {
   const int BUFFER_SIZE = 9;
@@ -134,121 +139,167 @@ char* getCurrentTime() {
   return buffer;
 }
 
-// Returns the protocol string cut off at the maximum of 5 characters
-char* getProtocolString() {
-  const int MAX_STR_LENGTH = 5;
-
-  char* protocolString = (char*)malloc(MAX_STR_LENGTH + 1);
-  const char* constProtocolString = IrReceiver.getProtocolString();
+void setRecentSignals() {
+  for (int i = 0; i < RECENT_SIGNAL_SIZE; i++) {
+    char* line = DATA_DISPLAY_OBJECTS[RECENT_SIGNAL_OBJECT + i].data;
+    const Signal* signal = getRecentSignal(i);
 
-  for (int i = 0; i < MAX_STR_LENGTH; i++) {
-    protocolString[i] = constProtocolString[i];
+    if (signal == NULL) {
+      line[0] = '\0';
+    } else {
+      snprintf(line, DATA_STRING_SIZE, "%.*s %d %d", PROTOCOL_NAME_LENGTH, protocolName(signal->protocol), signal->command, signal->address);
+    }
   }
+}
 
-  protocolString[MAX_STR_LENGTH] = '\0';
-  return protocolString;
+// (Re)starts the blink of the unknown signal icon, updateUnknownSignalAnim() plays it
+void startUnknownSignalAnim(unsigned long now) {
+  blinkStep = 0;
+  blinkStartMs = now;
 }
 
-void drawLine(Line line) {
-  if (line.direction == Horizontal) {
-    display.drawLine(line.x, line.y, line.x + line.length, line.y, LINE_COLOR);
-  } else if (line.direction == Vertical) {
-    display.drawLine(line.x, line.y, line.x, line.y + line.length, LINE_COLOR);
+// Draws the step of the blink that is due, never waits for the next one
+void updateUnknownSignalAnim(unsigned long now) {
+  if (blinkStep >= BLINK_COUNT * 2 || now - blinkStartMs < (unsigned long)blinkStep * BLINK_INTERVAL_MS) {
+    return;
   }
-}
 
-void displayDataObject(DataDisplayObject d) {
-  display.setCursor(d.x, d.y);
-  display.print(d.label);
-  display.print(d.data);
+  // A late loop skips to the step that is due now
+  int dueStep = (now - blinkStartMs) / BLINK_INTERVAL_MS;
+  blinkStep = dueStep < BLINK_COUNT * 2 ? dueStep : BLINK_COUNT * 2 - 1;
+
+  if (blinkStep % 2 == 0) {
+    blendFrameBitmap(ICON_POSITION_X, ICON_POSITION_Y, UNKNOWN_SIGNAL_BITMAP, ICON_SIZE_PIXELS, ICON_SIZE_PIXELS, BACKGROUND_COLOR);
+  } else {
+    restoreWidgetArea(ICON_POSITION_X, ICON_POSITION_Y, ICON_SIZE_PIXELS, ICON_SIZE_PIXELS);
+  }
+  blinkStep++;
 }
 
-void displayRecentSignals() {
-  const int positionX = 0;
-  const int positionY = 32;
+// Makes page the one on the screen and draws all of it, the widgets of the other page are left alone
+void showPage(Page page) {
+  if (page == SignalPage) {
+    beginWidgets(DATA_DISPLAY_OBJECTS, DISPLAY_SIZE, LAYOUT, LAYOUT_SIZE, LINE_COLOR, BACKGROUND_COLOR);
+  } else {
+    beginWidgets(ANALYTICS_DISPLAY_OBJECTS, ANALYTICS_DISPLAY_SIZE, ANALYTICS_LAYOUT, ANALYTICS_LAYOUT_SIZE, LINE_COLOR, BACKGROUND_COLOR);
+  }
 
-  display.setCursor(positionX, positionY);
+  drawAllWidgets();
+  shownPage = page;
+  layoutDrawn = true;
+}
 
-  for (int i = 0; i < RECENT_SIGNAL_SIZE; i++) {
-    if (recentSignals[i].protocol == NULL) {
-      continue;
-    }
+void displayData(const Signal* signal, unsigned long now) {
+  int repeats;
+  const SignalCounter* held = getHeldSignal(now, &repeats);
 
-    display.print(recentSignals[i].protocol);
-    display.print(" " + String(recentSignals[i].command) + " " + String(recentSignals[i].address));
+  snprintf(DATA_DISPLAY_OBJECTS[0].data, DATA_STRING_SIZE, "%s", getCurrentTime());
 
-    display.setCursor(positionX, display.getCursorY() + LINE_HEIGHT_PIXELS);
+  // A held down key shows how often it repeated
+  if (held != NULL && held->protocol == signal->protocol && held->address == signal->address && held->command == signal->command) {
+    snprintf(DATA_DISPLAY_OBJECTS[1].data, DATA_STRING_SIZE, "%.*s x%d", PROTOCOL_NAME_LENGTH, protocolName(signal->protocol), repeats);
+  } else {
+    snprintf(DATA_DISPLAY_OBJECTS[1].data, DATA_STRING_SIZE, "%.*s", PROTOCOL_NAME_LENGTH, protocolName(signal->protocol));
+  }
+  snprintf(DATA_DISPLAY_OBJECTS[2].data, DATA_STRING_SIZE, "%d", signal->command);
+  snprintf(DATA_DISPLAY_OBJECTS[3].data, DATA_STRING_SIZE, "%d", signal->address);
+  snprintf(DATA_DISPLAY_OBJECTS[4].data, DATA_STRING_SIZE, "%d", signalInputCounter);
+  setRecentSignals();
+
+  // Only the first signal draws the whole screen, after that only changed characters are sent
+  if (!layoutDrawn || shownPage != SignalPage) {
+    showPage(SignalPage);
+    return;
   }
+
+  updateWidgets();
 }
 
-void updateRecentSignals() {
-  Signal mostRecentSignal = { getProtocolString(), IrReceiver.decodedIRData.command, IrReceiver.decodedIRData.address };
+void displayAnalytics(unsigned long now) {
+  uint32_t rateWindow = signalsInWindow(now, RATE_WINDOW_SECONDS);
+  uint32_t rateTenths = rateWindow * 10 / RATE_WINDOW_SECONDS;
 
-  free(recentSignals[RECENT_SIGNAL_SIZE - 1].protocol);
+  snprintf(ANALYTICS_DISPLAY_OBJECTS[0].data, DATA_STRING_SIZE, "%lu.%lu", (unsigned long)rateTenths / 10, (unsigned long)rateTenths % 10);
+  snprintf(ANALYTICS_DISPLAY_OBJECTS[1].data, DATA_STRING_SIZE, "%lu", (unsigned long)signalsInWindow(now, ANALYTICS_WINDOW_SECONDS));
 
-  for (int i = RECENT_SIGNAL_SIZE - 1; i >= 0; i--) {
-    if (i == 0) {
-      recentSignals[i] = mostRecentSignal;
-    } else {
-      recentSignals[i] = recentSignals[i - 1];
-    }
+  const SignalCounter* longest = getLongestBurst();
+  if (longest == NULL || longest->longestBurst == 0) {
+    snprintf(ANALYTICS_DISPLAY_OBJECTS[2].data, DATA_STRING_SIZE, "-");
+  } else {
+    snprintf(ANALYTICS_DISPLAY_OBJECTS[2].data, DATA_STRING_SIZE, "%.*s %d x%d", PROTOCOL_NAME_LENGTH, protocolName(longest->protocol), longest->command, longest->longestBurst);
   }
-}
 
-void playUnknownSignalAnim() {
-  const int BLINK_COUNT = 3;
-  const int BLINK_INTERVAL_MS = 100;
+  const SignalCounter* const* top;
+  int topCount = getTopSignals(&top);
 
-  for (size_t i = 0; i < BLINK_COUNT; i++) {
-    display.drawRGBBitmap(ICON_POSITION_X, ICON_POSITION_Y, UNKNOWN_SIGNAL_BITMAP, ICON_SIZE_PIXELS, ICON_SIZE_PIXELS);
-    delay(BLINK_INTERVAL_MS);
-    display.writeFillRect(ICON_POSITION_X, ICON_POSITION_Y, ICON_SIZE_PIXELS, ICON_SIZE_PIXELS, BACKGROUND_COLOR);
-    delay(BLINK_INTERVAL_MS);
-  }
-}
+  for (int i = 0; i < ANALYTICS_TOP_SIZE; i++) {
+    char* line = ANALYTICS_DISPLAY_OBJECTS[TOP_SIGNAL_OBJECT + i].data;
 
-void displayLayout() {
-  for (int i = 0; i < LAYOUT_SIZE; i++) {
-    drawLine(LAYOUT[i]);
+    if (i < topCount) {
+      unsigned long count = min(top[i]->count, (uint32_t)SHOWN_COUNT_MAX);
+      snprintf(line, DATA_STRING_SIZE, "%lu %.*s %d %d", count, PROTOCOL_NAME_LENGTH, protocolName(top[i]->protocol), top[i]->command, top[i]->address);
+    } else {
+      line[0] = '\0';
+    }
   }
-}
-
-void displayData() {
-  DATA_DISPLAY_OBJECTS[0].data = getCurrentTime();
-  DATA_DISPLAY_OBJECTS[1].data = getProtocolString();
-  DATA_DISPLAY_OBJECTS[2].data = IrReceiver.decodedIRData.command;
-  DATA_DISPLAY_OBJECTS[3].data = IrReceiver.decodedIRData.address;
-  DATA_DISPLAY_OBJECTS[4].data = ++signalInputCounter;
 
-  for (size_t i = 0; i < DISPLAY_SIZE; i++) {
-    displayDataObject(DATA_DISPLAY_OBJECTS[i]);
+  if (shownPage != AnalyticsPage) {
+    showPage(AnalyticsPage);
+    return;
   }
 
-  updateRecentSignals();
-  displayRecentSignals();
+  updateWidgets();
 }
 
 void setup() {
   Serial.begin(SERIAL_MONITOR_BAUD_RATE);
 
   display.begin();
-  display.fillScreen(BACKGROUND_COLOR);
-  display.setTextColor(TEXT_COLOR);
 
-  IrReceiver.begin(IR_RECEIVE_PIN);
+  beginFrameBuffer(TEXT_COLOR, BACKGROUND_COLOR);
+  beginWidgets(DATA_DISPLAY_OBJECTS, DISPLAY_SIZE, LAYOUT, LAYOUT_SIZE, LINE_COLOR, BACKGROUND_COLOR);
+  startIrEvents(IR_RECEIVE_PIN);
 
-  display.print("Waiting for IR signal...");
+  drawFrameText(0, 0, "Waiting for IR signal...");
+  pushFrame(&display);
 }
 
 void loop() {
-  if (IrReceiver.decode()) {
-    if (IrReceiver.decodedIRData.protocol == UNKNOWN) {
-      playUnknownSignalAnim();
+  // Take every signal that arrived since the last redraw, the screen only shows the newest
+  IrEvent event;
+  bool signalReceived = false;
+  bool unknownReceived = false;
+
+  while (popIrEvent(&event)) {
+    recordIrAnalytics(&event);
+
+    if (event.protocol == UNKNOWN) {
+      unknownReceived = true;
     } else {
-      display.fillScreen(BACKGROUND_COLOR);
-      displayLayout();
-      displayData();
+      signalInputCounter++;
+      addSignal(&event);
+      signalReceived = true;
     }
-    IrReceiver.resume();
   }
+
+  // Read after the queue is empty, the IR task stamps the events on the other core and
+  // an event popped during the drain must not be newer than now
+  unsigned long now = millis();
+
+  if (unknownReceived) {
+    startUnknownSignalAnim(now);
+  }
+
+  if (signalReceived) {
+    displayData(getRecentSignal(0), now);
+    lastSignalMs = now;
+  } else if (layoutDrawn && now - lastSignalMs >= ANALYTICS_PAGE_IDLE_MS && now - lastAnalyticsMs >= ANALYTICS_REFRESH_MS) {
+    displayAnalytics(now);
+    lastAnalyticsMs = now;
+  }
+
+  updateUnknownSignalAnim(now);
+
+  // Everything drawn during this loop goes to the display in one transfer
+  pushFrame(&display);
 }
\ No newline at end of file
@@ -0,0 +1,45 @@
+/*
+
+  Fixed size history of the received IR signals.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#include "signalHistory.h"
+
+#include <IRremoteInt.h>
+
+static_assert((SIGNAL_HISTORY_SIZE & (SIGNAL_HISTORY_SIZE - 1)) == 0, "SIGNAL_HISTORY_SIZE must be a power of two");
+
+static Signal signalHistory[SIGNAL_HISTORY_SIZE];
+
+// Free running count of added signals, the newest one is at (signalsAdded - 1)
+static uint32_t signalsAdded = 0;
+
+void addSignal(const IrEvent* event) {
+  Signal* signal = &signalHistory[signalsAdded % SIGNAL_HISTORY_SIZE];
+
+  signal->protocol = event->protocol;
+  signal->command = event->command;
+  signal->address = event->address;
+  signal->timeMs = event->timeMs;
+
+  signalsAdded++;
+}
+
+int signalHistoryCount() {
+  return signalsAdded < SIGNAL_HISTORY_SIZE ? signalsAdded : SIGNAL_HISTORY_SIZE;
+}
+
+const Signal* getRecentSignal(int age) {
+  if (age < 0 || age >= signalHistoryCount()) {
+    return NULL;
+  }
+
+  return &signalHistory[(signalsAdded - 1 - age) % SIGNAL_HISTORY_SIZE];
+}
+
+const char* protocolName(uint8_t protocol) {
+  return getProtocolString((decode_type_t)protocol);
+}
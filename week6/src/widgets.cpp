@@ -0,0 +1,150 @@
+/*
+
+  Retained widgets of the sensor display.
+
+  Written by Jesse van Vuuren, Pieter van Turenhout and Wilmar van der Plas (2024)
+
+*/
+
+#include "widgets.h"
+
+static DataDisplayObject* widgetObjects;
+static int widgetCount;
+
+static const Line* widgetLines;
+static int widgetLineCount;
+
+static uint16_t widgetLineColor;
+static uint16_t widgetBackgroundColor;
+
+void beginWidgets(DataDisplayObject* objects, int count, const Line* lines, int lineCount, uint16_t lineColor, uint16_t backgroundColor) {
+  widgetObjects = objects;
+  widgetCount = count;
+  widgetLines = lines;
+  widgetLineCount = lineCount;
+  widgetLineColor = lineColor;
+  widgetBackgroundColor = backgroundColor;
+}
+
+// Draws the parts of the lines inside the box, a line ends on the pixel at its length like drawLine()
+static void drawLinesInside(int x, int y, int width, int height) {
+  for (int i = 0; i < widgetLineCount; i++) {
+    Line line = widgetLines[i];
+
+    if (line.direction == Horizontal) {
+      int begin = max(line.x, x);
+      int end = min(line.x + line.length + 1, x + width);
+
+      if (line.y >= y && line.y < y + height && begin < end) {
+        fillFrameRect(begin, line.y, end - begin, 1, widgetLineColor);
+      }
+    } else if (line.direction == Vertical) {
+      int begin = max(line.y, y);
+      int end = min(line.y + line.length + 1, y + height);
+
+      if (line.x >= x && line.x < x + width && begin < end) {
+        fillFrameRect(line.x, begin, 1, end - begin, widgetLineColor);
+      }
+    }
+  }
+}
+
+// The character drawn in cell i of text, a space past its end
+static char cellAt(const char* text, int length, int i) {
+  return i < length ? text[i] : ' ';
+}
+
+static void drawCells(int x, int y, const char* text, int length) {
+  for (int i = 0; i < length; i++) {
+    if (text[i] != ' ') {
+      drawFrameGlyph(x + i * CHAR_WIDTH_PIXELS, y, text[i]);
+    }
+  }
+}
+
+void drawAllWidgets() {
+  fillFrameRect(0, 0, FRAME_WIDTH, FRAME_HEIGHT, widgetBackgroundColor);
+  drawLinesInside(0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+
+  for (int i = 0; i < widgetCount; i++) {
+    DataDisplayObject* object = &widgetObjects[i];
+    int labelLength = strlen(object->label);
+
+    drawCells(object->x, object->y, object->label, labelLength);
+    drawCells(object->x + labelLength * CHAR_WIDTH_PIXELS, object->y, object->data, strlen(object->data));
+    strcpy(object->shown, object->data);
+  }
+}
+
+static void updateWidget(DataDisplayObject* object) {
+  int x = object->x + strlen(object->label) * CHAR_WIDTH_PIXELS;
+  int dataLength = strlen(object->data);
+  int shownLength = strlen(object->shown);
+  int cells = max(dataLength, shownLength);
+
+  // Every run of changed cells is cleared as one box and drawn again
+  int i = 0;
+  while (i < cells) {
+    if (cellAt(object->data, dataLength, i) == cellAt(object->shown, shownLength, i)) {
+      i++;
+      continue;
+    }
+
+    int begin = i;
+    while (i < cells && cellAt(object->data, dataLength, i) != cellAt(object->shown, shownLength, i)) {
+      i++;
+    }
+
+    int boxX = x + begin * CHAR_WIDTH_PIXELS;
+    int boxWidth = (i - begin) * CHAR_WIDTH_PIXELS;
+
+    fillFrameRect(boxX, object->y, boxWidth, CHAR_HEIGHT_PIXELS, widgetBackgroundColor);
+    drawLinesInside(boxX, object->y, boxWidth, CHAR_HEIGHT_PIXELS);
+    drawCells(boxX, object->y, &object->data[begin], min(i, dataLength) - begin);
+  }
+
+  strcpy(object->shown, object->data);
+}
+
+void updateWidgets() {
+  for (int i = 0; i < widgetCount; i++) {
+    updateWidget(&widgetObjects[i]);
+  }
+}
+
+// Draws the cells of text that overlap the box, whole cells so the glyphs stay intact
+static void drawCellsInside(int textX, int textY, const char* text, int x, int y, int width, int height) {
+  if (textY + CHAR_HEIGHT_PIXELS <= y || textY >= y + height) {
+    return;
+  }
+
+  for (int i = 0; text[i] != '\0'; i++) {
+    int cellX = textX + i * CHAR_WIDTH_PIXELS;
+
+    if (cellX + CHAR_WIDTH_PIXELS > x && cellX < x + width && text[i] != ' ') {
+      drawFrameGlyph(cellX, textY, text[i]);
+    }
+  }
+}
+
+void restoreWidgetArea(int x, int y, int width, int height) {
+  fillFrameRect(x, y, width, height, widgetBackgroundColor);
+  drawLinesInside(x, y, width, height);
+
+  for (int i = 0; i < widgetCount; i++) {
+    const DataDisplayObject* object = &widgetObjects[i];
+
+    drawCellsInside(object->x, object->y, object->label, x, y, width, height);
+    drawCellsInside(object->x + strlen(object->label) * CHAR_WIDTH_PIXELS, object->y, object->shown, x, y, width, height);
+  }
+}
+
+const DataDisplayObject* getWidgets(int* count) {
+  *count = widgetCount;
+  return widgetObjects;
+}
+
+const Line* getWidgetLines(int* lineCount) {
+  *lineCount = widgetLineCount;
+  return widgetLines;
+}